@@ -12,6 +12,15 @@
     #error "Unsupported platform"
 #endif
 
+/* Padding unit for per-waiter spin words (Apple/Neoverse prefetch in pairs) */
+#ifndef CAS_LOCK_CACHELINE
+#if CAS_LOCK_ARM64
+    #define CAS_LOCK_CACHELINE 128
+#else
+    #define CAS_LOCK_CACHELINE 64
+#endif
+#endif
+
 /* ============================================================================
  * ARM64 (AArch64) Implementation
  * ============================================================================ */
@@ -181,6 +190,15 @@ static inline void cpu_pause(void)
  * Common helper functions (platform-independent)
  * ============================================================================ */
 
+/*
+ * Spin-poll hook, invoked each time a waiter re-reads a contended word.
+ * Benchmarks may define it before including any lock header to count
+ * polls as a proxy for coherence traffic.
+ */
+#ifndef CAS_LOCK_POLL_HOOK
+#define CAS_LOCK_POLL_HOOK() ((void)0)
+#endif
+
 /* Atomic fetch-and-sub - returns old value */
 static inline uint32_t atomic_fetch_sub(volatile uint32_t *ptr, uint32_t value)
 {
@@ -218,4 +236,67 @@ static inline int atomic_cmpxchg_bool(volatile uint32_t *ptr, uint32_t expected,
     return (old == expected);
 }
 
+/*
+ * 64-bit variants, for locks that pack two 32-bit fields into one word.
+ * The GCC builtins lower to LDAR/STLR/LDAXR/STLXR on ARM64 and to plain
+ * MOV/LOCK-prefixed instructions on x86_64.
+ */
+static inline uint64_t atomic_load64(const volatile uint64_t *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+static inline void atomic_store64(volatile uint64_t *ptr, uint64_t value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+}
+
+/* Atomic fetch-and-add - returns old value */
+static inline uint64_t atomic_fetch_add64(volatile uint64_t *ptr, uint64_t value)
+{
+    return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/* Atomic compare-and-swap with success indication */
+static inline int atomic_cmpxchg64_bool(volatile uint64_t *ptr, uint64_t expected, uint64_t desired)
+{
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Pointer-width variants, for locks that publish node or array pointers.
+ * Callers cast their field address to (void *volatile *).
+ */
+static inline void *atomic_load_ptr(void *volatile const *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+static inline void *atomic_load_ptr_acquire(void *volatile const *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_store_ptr(void *volatile *ptr, void *value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+}
+
+static inline void atomic_store_ptr_release(void *volatile *ptr, void *value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/* Atomic exchange - returns old value */
+static inline void *atomic_xchg_ptr(void *volatile *ptr, void *value)
+{
+    return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/* Atomic compare-and-swap with success indication */
+static inline int atomic_cmpxchg_ptr_bool(void *volatile *ptr, void *expected, void *desired)
+{
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
 #endif /* CAS_LOCK_ATOMIC_H */
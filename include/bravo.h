@@ -0,0 +1,168 @@
+#ifndef CAS_LOCK_BRAVO_H
+#define CAS_LOCK_BRAVO_H
+
+#include "atomic.h"
+#include "platform.h"
+#include "rwlock.h"
+
+/*
+ * BRAVO - Biased Locking for Reader-Writer Locks (Dice and Kogan)
+ * Wraps any reader-writer lock of this library.  While the lock is read
+ * biased, a reader does not touch the inner lock at all: it CASes the
+ * lock's address into a slot of a global visible readers table, picked by
+ * hashing the lock and the thread, and re-checks the bias.  Readers of
+ * different threads thus write to different slots, never to a shared
+ * counter.  Slots are not padded, to keep the writer's scan short, so a
+ * few readers hashed near each other still share a cache line.  A reader
+ * whose slot is taken, or that finds the bias off, falls back to the
+ * inner lock.
+ *
+ * A writer takes the inner write lock, which keeps slow-path readers out,
+ * then revokes the bias and waits until no slot holds the lock's address.
+ * The scan costs the whole table, so after a revocation the bias stays
+ * off for BRAVO_INHIBIT_MULT times as long as the scan took; a slow-path
+ * reader re-enables it once that time has passed.
+ *
+ * The table is a weak global shared by all translation units and all
+ * BRAVO locks.  bravo_read_lock() returns the slot it used, or NULL for
+ * the slow path, to be passed back to bravo_read_unlock().
+ */
+#ifndef BRAVO_TABLE_SIZE
+#define BRAVO_TABLE_SIZE 4096       /* power of two */
+#endif
+
+#ifndef BRAVO_INHIBIT_MULT
+#define BRAVO_INHIBIT_MULT 9
+#endif
+
+typedef void *volatile bravo_slot_t;
+
+__attribute__((weak)) bravo_slot_t bravo_table[BRAVO_TABLE_SIZE];
+__attribute__((weak)) __thread char bravo_thread_tag;
+
+typedef void (*bravo_lock_fn)(void *lock);
+
+typedef struct {
+    volatile uint32_t rbias;        /* readers may use the table */
+    volatile uint64_t inhibit_until;    /* cas_clock_ns() time */
+    void *inner;
+    bravo_lock_fn read_lock_fn;
+    bravo_lock_fn read_unlock_fn;
+    bravo_lock_fn write_lock_fn;
+    bravo_lock_fn write_unlock_fn;
+} bravo_lock_t;
+
+static inline void bravo_init(bravo_lock_t *lock, void *inner,
+                              bravo_lock_fn read_lock_fn, bravo_lock_fn read_unlock_fn,
+                              bravo_lock_fn write_lock_fn, bravo_lock_fn write_unlock_fn)
+{
+    atomic_store(&lock->rbias, 1);
+    atomic_store64(&lock->inhibit_until, 0);
+    lock->inner = inner;
+    lock->read_lock_fn = read_lock_fn;
+    lock->read_unlock_fn = read_unlock_fn;
+    lock->write_lock_fn = write_lock_fn;
+    lock->write_unlock_fn = write_unlock_fn;
+}
+
+/* Slot for this thread and lock: mix both addresses, keep the top bits */
+static inline bravo_slot_t *bravo_slot(bravo_lock_t *lock)
+{
+    uint64_t h = ((uint64_t)(uintptr_t)lock ^ (uint64_t)(uintptr_t)&bravo_thread_tag) *
+                 0x9e3779b97f4a7c15ULL;
+    return &bravo_table[(h >> 32) & (BRAVO_TABLE_SIZE - 1)];
+}
+
+static inline bravo_slot_t *bravo_read_lock(bravo_lock_t *lock)
+{
+    bravo_slot_t *slot;
+
+    if (atomic_load(&lock->rbias) != 0) {
+        slot = bravo_slot(lock);
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)slot, NULL, lock)) {
+            /* Publish the slot before re-checking; pairs with the writer */
+            mb();
+            if (atomic_load(&lock->rbias) != 0) {
+                return slot;
+            }
+            atomic_store_ptr_release((void *volatile *)slot, NULL);
+        }
+    }
+
+    lock->read_lock_fn(lock->inner);
+    if (atomic_load(&lock->rbias) == 0 && cas_clock_ns() >= atomic_load64(&lock->inhibit_until)) {
+        atomic_store(&lock->rbias, 1);
+    }
+    return NULL;
+}
+
+static inline void bravo_read_unlock(bravo_lock_t *lock, bravo_slot_t *slot)
+{
+    if (slot != NULL) {
+        atomic_store_ptr_release((void *volatile *)slot, NULL);
+    } else {
+        lock->read_unlock_fn(lock->inner);
+    }
+}
+
+static inline void bravo_write_lock(bravo_lock_t *lock)
+{
+    uint64_t start, now;
+    uint32_t i;
+
+    lock->write_lock_fn(lock->inner);
+    if (atomic_load(&lock->rbias) == 0) {
+        return;
+    }
+
+    atomic_store(&lock->rbias, 0);
+    mb();
+    start = cas_clock_ns();
+    for (i = 0; i < BRAVO_TABLE_SIZE; i++) {
+        while (atomic_load_ptr_acquire((void *volatile *)&bravo_table[i]) == lock) {
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+    }
+    now = cas_clock_ns();
+    atomic_store64(&lock->inhibit_until, now + (now - start) * BRAVO_INHIBIT_MULT);
+}
+
+static inline void bravo_write_unlock(bravo_lock_t *lock)
+{
+    lock->write_unlock_fn(lock->inner);
+}
+
+/* Adapters for the library's reader-writer locks */
+static inline void bravo_rw_read_lock_fn(void *lock) { rw_read_lock((rwlock_t *)lock); }
+static inline void bravo_rw_read_unlock_fn(void *lock) { rw_read_unlock((rwlock_t *)lock); }
+static inline void bravo_rw_write_lock_fn(void *lock) { rw_write_lock((rwlock_t *)lock); }
+static inline void bravo_rw_write_unlock_fn(void *lock) { rw_write_unlock((rwlock_t *)lock); }
+static inline void bravo_phase_read_lock_fn(void *lock) { rw_phase_read_lock((rwlock_phase_t *)lock); }
+static inline void bravo_phase_read_unlock_fn(void *lock) { rw_phase_read_unlock((rwlock_phase_t *)lock); }
+static inline void bravo_phase_write_lock_fn(void *lock) { rw_phase_write_lock((rwlock_phase_t *)lock); }
+static inline void bravo_phase_write_unlock_fn(void *lock) { rw_phase_write_unlock((rwlock_phase_t *)lock); }
+static inline void bravo_ticket_read_lock_fn(void *lock) { rw_ticket_read_lock((rwlock_ticket_t *)lock); }
+static inline void bravo_ticket_read_unlock_fn(void *lock) { rw_ticket_read_unlock((rwlock_ticket_t *)lock); }
+static inline void bravo_ticket_write_lock_fn(void *lock) { rw_ticket_write_lock((rwlock_ticket_t *)lock); }
+static inline void bravo_ticket_write_unlock_fn(void *lock) { rw_ticket_write_unlock((rwlock_ticket_t *)lock); }
+
+static inline void bravo_init_rw(bravo_lock_t *lock, rwlock_t *inner)
+{
+    bravo_init(lock, inner, bravo_rw_read_lock_fn, bravo_rw_read_unlock_fn,
+               bravo_rw_write_lock_fn, bravo_rw_write_unlock_fn);
+}
+
+static inline void bravo_init_phase(bravo_lock_t *lock, rwlock_phase_t *inner)
+{
+    bravo_init(lock, inner, bravo_phase_read_lock_fn, bravo_phase_read_unlock_fn,
+               bravo_phase_write_lock_fn, bravo_phase_write_unlock_fn);
+}
+
+static inline void bravo_init_ticket(bravo_lock_t *lock, rwlock_ticket_t *inner)
+{
+    bravo_init(lock, inner, bravo_ticket_read_lock_fn, bravo_ticket_read_unlock_fn,
+               bravo_ticket_write_lock_fn, bravo_ticket_write_unlock_fn);
+}
+
+#endif /* CAS_LOCK_BRAVO_H */
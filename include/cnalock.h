@@ -0,0 +1,166 @@
+#ifndef CAS_LOCK_CNALOCK_H
+#define CAS_LOCK_CNALOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+
+/*
+ * Compact NUMA-Aware Lock (Dice and Kogan, CNA)
+ * An MCS lock whose releaser prefers a successor on its own NUMA node.
+ * Waiters from other nodes that it passes over are moved to a secondary
+ * queue.  The head of that queue travels with the lock in the spin word
+ * of each holder's node, so the lock itself is still one pointer.  The
+ * secondary queue goes back in front of the main queue when the main
+ * queue runs dry, or after CNA_INTRA_NODE_THRESHOLD local handoffs in a
+ * row, which bounds how long remote waiters can be passed over.
+ *
+ * A waiter's node is taken from cna_numa_node(), cached per thread on
+ * first use.  cna_set_numa_node() overrides it, e.g. to treat CPU sets
+ * as fake nodes.
+ */
+#ifndef CNA_INTRA_NODE_THRESHOLD
+#define CNA_INTRA_NODE_THRESHOLD 65536
+#endif
+
+/* spin word: 0 = waiting, 1 = granted, else granted + secondary queue head */
+#define CNA_WAITING 0
+#define CNA_GRANTED 1
+
+typedef struct cna_node {
+    struct cna_node *volatile next;
+    volatile uintptr_t spin;
+    uint32_t numa_node;
+    uint32_t intra_count;           /* local handoffs since the last flush */
+    struct cna_node *sec_tail;      /* valid in the secondary queue head */
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) cna_node_t;
+
+typedef struct {
+    cna_node_t *volatile tail;
+} cna_lock_t;
+
+#define CNA_LOCK_INITIALIZER {NULL}
+
+/* Cached NUMA node of this thread, CNA_NODE_UNKNOWN until first use */
+#define CNA_NODE_UNKNOWN UINT32_MAX
+
+__attribute__((weak)) __thread uint32_t cna_thread_node = CNA_NODE_UNKNOWN;
+
+static inline uint32_t cna_numa_node(void)
+{
+    if (cna_thread_node == CNA_NODE_UNKNOWN) {
+        cna_thread_node = cas_numa_node();
+    }
+    return cna_thread_node;
+}
+
+/* Override the calling thread's NUMA node */
+static inline void cna_set_numa_node(uint32_t node)
+{
+    cna_thread_node = node;
+}
+
+static inline void cna_init(cna_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+}
+
+static inline void cna_lock(cna_lock_t *lock, cna_node_t *node)
+{
+    cna_node_t *prev;
+
+    node->next = NULL;
+    node->spin = CNA_WAITING;
+    node->numa_node = cna_numa_node();
+    node->intra_count = 0;
+
+    prev = (cna_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, node);
+    if (prev == NULL) {
+        node->spin = CNA_GRANTED;
+        return;
+    }
+
+    /* numa_node is published by the release store of the link */
+    atomic_store_ptr_release((void *volatile *)&prev->next, node);
+
+    while (__atomic_load_n(&node->spin, __ATOMIC_ACQUIRE) == CNA_WAITING) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+}
+
+/*
+ * Look past node->next for a waiter on our NUMA node.  Waiters skipped
+ * on the way are appended to the secondary queue in node->spin.
+ */
+static inline cna_node_t *cna_find_successor(cna_node_t *node)
+{
+    cna_node_t *next = (cna_node_t *)node->next;
+    cna_node_t *sec_head, *sec_tail, *cur;
+
+    if (next->numa_node == node->numa_node) {
+        return next;
+    }
+
+    sec_head = next;
+    sec_tail = next;
+    cur = (cna_node_t *)atomic_load_ptr_acquire((void *volatile *)&next->next);
+
+    while (cur != NULL) {
+        if (cur->numa_node == node->numa_node) {
+            /* Only the tail's next can still change, and cur is past them */
+            if (node->spin > CNA_GRANTED) {
+                ((cna_node_t *)node->spin)->sec_tail->next = sec_head;
+            } else {
+                node->spin = (uintptr_t)sec_head;
+            }
+            sec_tail->next = NULL;
+            ((cna_node_t *)node->spin)->sec_tail = sec_tail;
+            return cur;
+        }
+        sec_tail = cur;
+        cur = (cna_node_t *)atomic_load_ptr_acquire((void *volatile *)&cur->next);
+    }
+    return NULL;
+}
+
+static inline void cna_unlock(cna_lock_t *lock, cna_node_t *node)
+{
+    cna_node_t *next = (cna_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+    cna_node_t *succ;
+
+    if (next == NULL) {
+        if (node->spin == CNA_GRANTED) {
+            if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, node, NULL)) {
+                return;
+            }
+        } else {
+            /* Main queue empty: the secondary queue becomes the queue */
+            cna_node_t *sec_head = (cna_node_t *)node->spin;
+            if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, node,
+                                        sec_head->sec_tail)) {
+                __atomic_store_n(&sec_head->spin, (uintptr_t)CNA_GRANTED, __ATOMIC_RELEASE);
+                return;
+            }
+        }
+        while ((next = (cna_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next)) == NULL) {
+            cpu_pause();
+        }
+    }
+
+    if (node->intra_count < CNA_INTRA_NODE_THRESHOLD &&
+        (succ = cna_find_successor(node)) != NULL) {
+        /* Local handoff; the secondary queue (if any) rides along */
+        succ->intra_count = node->intra_count + 1;
+        __atomic_store_n(&succ->spin, node->spin, __ATOMIC_RELEASE);
+    } else if (node->spin > CNA_GRANTED) {
+        /* Flush: remote waiters go first, then the rest of the main queue */
+        succ = (cna_node_t *)node->spin;
+        succ->sec_tail->next = (cna_node_t *)node->next;
+        __atomic_store_n(&succ->spin, (uintptr_t)CNA_GRANTED, __ATOMIC_RELEASE);
+    } else {
+        succ = next;
+        __atomic_store_n(&succ->spin, (uintptr_t)CNA_GRANTED, __ATOMIC_RELEASE);
+    }
+}
+
+#endif /* CAS_LOCK_CNALOCK_H */
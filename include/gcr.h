@@ -0,0 +1,134 @@
+#ifndef CAS_LOCK_GCR_H
+#define CAS_LOCK_GCR_H
+
+#include "atomic.h"
+#include "platform.h"
+#include "spinlock.h"
+#include "ticketlock.h"
+#include "mcslock.h"
+
+/*
+ * Generic Concurrency Restriction (Dice and Kogan, GCR)
+ * Wraps any lock of this library and lets at most `max_active` threads
+ * contend on it at a time.  Threads past that limit wait in a passive
+ * queue, itself an MCS-park lock: its holder is the next thread to be let
+ * in and spins for a free slot, everyone behind it parks.  The inner lock
+ * thus only ever sees a few contenders, however many threads there are.
+ *
+ * The active count is only checked on arrival, so a steady stream of
+ * newcomers could keep the queue waiting.  Every GCR_FAIRNESS_PERIOD
+ * releases the releaser approves the queue's head, if there is one, which
+ * then enters even if that briefly puts one thread above the limit.  A
+ * head that finds a free slot first drops the approval, so it is never
+ * left over for a later head.
+ */
+#define GCR_DEFAULT_MAX_ACTIVE 4
+
+#ifndef GCR_FAIRNESS_PERIOD
+#define GCR_FAIRNESS_PERIOD 4096
+#endif
+
+typedef void (*gcr_lock_fn)(void *lock);
+
+typedef struct {
+    void *inner;
+    gcr_lock_fn lock_fn;
+    gcr_lock_fn unlock_fn;
+    uint32_t max_active;
+    uint32_t releases;              /* written under the inner lock */
+    volatile uint32_t active;       /* threads admitted to the inner lock */
+    volatile uint32_t top_approved;
+    mcs_park_lock_t passive;
+} gcr_lock_t;
+
+/* max_active 0 selects GCR_DEFAULT_MAX_ACTIVE */
+static inline void gcr_init(gcr_lock_t *gcr, void *inner, gcr_lock_fn lock_fn,
+                            gcr_lock_fn unlock_fn, uint32_t max_active)
+{
+    gcr->inner = inner;
+    gcr->lock_fn = lock_fn;
+    gcr->unlock_fn = unlock_fn;
+    gcr->max_active = max_active != 0 ? max_active : GCR_DEFAULT_MAX_ACTIVE;
+    gcr->releases = 0;
+    atomic_store(&gcr->active, 0);
+    atomic_store(&gcr->top_approved, 0);
+    mcs_park_init(&gcr->passive);
+}
+
+/* Take an active slot if one is free */
+static inline int gcr_try_enter(gcr_lock_t *gcr)
+{
+    uint32_t active = atomic_load(&gcr->active);
+
+    while (active < gcr->max_active) {
+        if (atomic_cmpxchg_bool(&gcr->active, active, active + 1)) {
+            return 1;
+        }
+        active = atomic_load(&gcr->active);
+    }
+    return 0;
+}
+
+static inline void gcr_lock(gcr_lock_t *gcr)
+{
+    mcs_park_node_t node;
+
+    if (!gcr_try_enter(gcr)) {
+        mcs_park_lock(&gcr->passive, &node);
+        while (!gcr_try_enter(gcr)) {
+            if (atomic_load(&gcr->top_approved) != 0) {
+                atomic_fetch_add(&gcr->active, 1);
+                break;
+            }
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+        atomic_store(&gcr->top_approved, 0);
+        mcs_park_unlock(&gcr->passive, &node);
+    }
+
+    gcr->lock_fn(gcr->inner);
+}
+
+static inline void gcr_unlock(gcr_lock_t *gcr)
+{
+    if (++gcr->releases % GCR_FAIRNESS_PERIOD == 0 &&
+        atomic_load_ptr((void *volatile *)&gcr->passive.tail) != NULL) {
+        atomic_store(&gcr->top_approved, 1);
+    }
+    gcr->unlock_fn(gcr->inner);
+    atomic_dec(&gcr->active);
+}
+
+/* Adapters for the library's locks */
+static inline void gcr_spin_lock_fn(void *lock) { spin_lock((spinlock_t *)lock); }
+static inline void gcr_spin_unlock_fn(void *lock) { spin_unlock((spinlock_t *)lock); }
+static inline void gcr_tatas_lock_fn(void *lock) { tatas_lock((tatas_lock_t *)lock); }
+static inline void gcr_tatas_unlock_fn(void *lock) { tatas_unlock((tatas_lock_t *)lock); }
+static inline void gcr_ticket_lock_fn(void *lock) { ticket_lock((ticketlock_t *)lock); }
+static inline void gcr_ticket_unlock_fn(void *lock) { ticket_unlock((ticketlock_t *)lock); }
+static inline void gcr_mcs_lock_fn(void *lock) { mcs_lock((mcs_lock_t *)lock); }
+static inline void gcr_mcs_unlock_fn(void *lock) { mcs_unlock((mcs_lock_t *)lock); }
+
+static inline void gcr_init_spin(gcr_lock_t *gcr, spinlock_t *lock, uint32_t max_active)
+{
+    gcr_init(gcr, lock, gcr_spin_lock_fn, gcr_spin_unlock_fn, max_active);
+}
+
+static inline void gcr_init_tatas(gcr_lock_t *gcr, tatas_lock_t *lock, uint32_t max_active)
+{
+    gcr_init(gcr, lock, gcr_tatas_lock_fn, gcr_tatas_unlock_fn, max_active);
+}
+
+static inline void gcr_init_ticket(gcr_lock_t *gcr, ticketlock_t *lock, uint32_t max_active)
+{
+    gcr_init(gcr, lock, gcr_ticket_lock_fn, gcr_ticket_unlock_fn, max_active);
+}
+
+/* Uses the implicit-node MCS API, so it counts against MCS_MAX_NESTING */
+static inline void gcr_init_mcs(gcr_lock_t *gcr, mcs_lock_t *lock, uint32_t max_active)
+{
+    gcr_init(gcr, lock, gcr_mcs_lock_fn, gcr_mcs_unlock_fn, max_active);
+}
+
+#endif /* CAS_LOCK_GCR_H */
@@ -0,0 +1,259 @@
+#ifndef CAS_LOCK_HMCSLOCK_H
+#define CAS_LOCK_HMCSLOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+#include "mcslock.h"
+#include <string.h>
+
+/*
+ * Hierarchical MCS Lock (Chabbi, Fagan and Mellor-Crummey, HMCS)
+ * A tree of MCS locks following the machine: leaves group CPUs that share
+ * a core, inner levels CPUs sharing an L3 and a socket, and a single root.
+ * A thread queues at its CPU's leaf; the first waiter of a cohort climbs
+ * to the parent on behalf of the whole group.  On release the lock is
+ * passed to the next waiter in the same group, up to `threshold` times in
+ * a row, before the group gives up the parent level.
+ *
+ * Levels come from /sys topology when hmcs_init() runs; a level that
+ * groups nothing beyond the level below it (no SMT, one L3 per socket,
+ * one socket) is left out, so on a flat machine this is plain MCS.  Each
+ * level is an MCS queue of mcs_node_t whose locked word carries the
+ * cohort status instead of a flag, so levels keep a bare tail rather than
+ * an mcs_lock_t and never go through the MCS API.
+ */
+#define HMCS_DEFAULT_THRESHOLD 64
+
+/* Node status: below HMCS_ACQUIRE_PARENT it counts local handoffs */
+#define HMCS_COHORT_START   1U
+#define HMCS_ACQUIRE_PARENT (UINT32_MAX - 1)
+#define HMCS_WAIT           UINT32_MAX
+
+typedef struct hmcs_level {
+    mcs_node_t *volatile tail;      /* waiters at this level */
+    mcs_node_t node;                /* this group's place in the parent */
+    struct hmcs_level *parent;      /* NULL at the root */
+    uint32_t threshold;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) hmcs_level_t;
+
+typedef struct {
+    hmcs_level_t *levels;           /* every level object, root last */
+    hmcs_level_t **leaf_of_cpu;
+    uint32_t num_levels;
+    uint32_t num_cpus;
+    uint32_t depth;                 /* levels from a leaf to the root */
+} hmcs_lock_t;
+
+/* Per-acquisition node; remembers the leaf for unlock */
+typedef struct {
+    mcs_node_t qnode;
+    hmcs_level_t *leaf;
+} hmcs_node_t;
+
+/* Cached CPU of this thread, HMCS_CPU_UNKNOWN until first use */
+#define HMCS_CPU_UNKNOWN UINT32_MAX
+
+__attribute__((weak)) __thread uint32_t hmcs_thread_cpu = HMCS_CPU_UNKNOWN;
+
+/* Override the CPU the calling thread queues under */
+static inline void hmcs_set_cpu(uint32_t cpu)
+{
+    hmcs_thread_cpu = cpu;
+}
+
+static inline void hmcs_level_init(hmcs_level_t *level, hmcs_level_t *parent,
+                                   uint32_t threshold)
+{
+    atomic_store_ptr((void *volatile *)&level->tail, NULL);
+    mcs_node_init(&level->node);
+    level->parent = parent;
+    level->threshold = threshold;
+}
+
+/*
+ * Build the level tree - returns 0 on success, -1 on allocation failure.
+ * threshold 0 selects HMCS_DEFAULT_THRESHOLD.
+ */
+static inline int hmcs_init(hmcs_lock_t *lock, uint32_t threshold)
+{
+    uint32_t ncpus = cas_num_cpus();
+    uint32_t *group[CAS_TOPO_LEVELS];
+    uint32_t groups[CAS_TOPO_LEVELS];
+    int kept[CAS_TOPO_LEVELS];
+    hmcs_level_t **cur, **next;
+    uint32_t prev_groups = ncpus;
+    uint32_t total = 1, depth = 1, n = 0;
+    uint32_t c, g;
+    int k, ok = 0;
+
+    if (threshold == 0) {
+        threshold = HMCS_DEFAULT_THRESHOLD;
+    }
+
+    memset(group, 0, sizeof(group));
+    cur = (hmcs_level_t **)malloc(ncpus * sizeof(*cur));
+    next = (hmcs_level_t **)malloc(ncpus * sizeof(*next));
+    if (cur == NULL || next == NULL) {
+        goto out;
+    }
+
+    /* Keep a level only if it is coarser than the kept level below it */
+    for (k = 0; k < CAS_TOPO_LEVELS; k++) {
+        group[k] = (uint32_t *)malloc(ncpus * sizeof(uint32_t));
+        if (group[k] == NULL) {
+            goto out;
+        }
+        groups[k] = 0;
+        for (c = 0; c < ncpus; c++) {
+            g = cas_cpu_group(c, k);
+            group[k][c] = g < ncpus ? g : c;
+            groups[k] += group[k][c] == c;
+        }
+        kept[k] = groups[k] < prev_groups && groups[k] > 1;
+        if (kept[k]) {
+            prev_groups = groups[k];
+            total += groups[k];
+            depth++;
+        }
+    }
+
+    lock->levels = (hmcs_level_t *)cas_default_alloc(total * sizeof(hmcs_level_t),
+                                                     CAS_LOCK_CACHELINE);
+    if (lock->levels == NULL) {
+        goto out;
+    }
+
+    /* Root last; build downwards so every group finds its parent */
+    hmcs_level_init(&lock->levels[total - 1], NULL, threshold);
+    for (c = 0; c < ncpus; c++) {
+        cur[c] = &lock->levels[total - 1];
+    }
+    for (k = CAS_TOPO_LEVELS - 1; k >= 0; k--) {
+        if (!kept[k]) {
+            continue;
+        }
+        for (c = 0; c < ncpus; c++) {
+            if (group[k][c] == c) {
+                hmcs_level_init(&lock->levels[n], cur[c], threshold);
+                next[c] = &lock->levels[n++];
+            }
+        }
+        for (c = 0; c < ncpus; c++) {
+            next[c] = next[group[k][c]];
+        }
+        memcpy(cur, next, ncpus * sizeof(*cur));
+    }
+
+    lock->leaf_of_cpu = cur;
+    lock->num_levels = total;
+    lock->num_cpus = ncpus;
+    lock->depth = depth;
+    cur = NULL;
+    ok = 1;
+
+out:
+    for (k = 0; k < CAS_TOPO_LEVELS; k++) {
+        free(group[k]);
+    }
+    free(cur);
+    free(next);
+    return ok ? 0 : -1;
+}
+
+static inline void hmcs_destroy(hmcs_lock_t *lock)
+{
+    cas_default_free(lock->levels);
+    free(lock->leaf_of_cpu);
+    lock->levels = NULL;
+    lock->leaf_of_cpu = NULL;
+}
+
+/* Queue at `level`, climbing while we are the first of our cohort */
+static inline void hmcs_acquire(hmcs_level_t *level, mcs_node_t *node)
+{
+    mcs_node_t *prev;
+    uint32_t status;
+
+    for (;;) {
+        node->next = NULL;
+        node->locked = HMCS_WAIT;
+
+        prev = (mcs_node_t *)atomic_xchg_ptr((void *volatile *)&level->tail, node);
+        if (prev != NULL) {
+            atomic_store_ptr_release((void *volatile *)&prev->next, node);
+
+            while ((status = atomic_load_acquire(&node->locked)) == HMCS_WAIT) {
+                CAS_LOCK_POLL_HOOK();
+                cpu_pause();
+            }
+            /* Passed within the cohort: the parent is already ours */
+            if (status < HMCS_ACQUIRE_PARENT) {
+                return;
+            }
+        }
+
+        node->locked = HMCS_COHORT_START;
+        if (level->parent == NULL) {
+            return;
+        }
+        node = &level->node;
+        level = level->parent;
+    }
+}
+
+/* Hand `level` to the successor with `status`, or empty the queue */
+static inline void hmcs_pass(hmcs_level_t *level, mcs_node_t *node, uint32_t status)
+{
+    mcs_node_t *next = (mcs_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+
+    if (next == NULL) {
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)&level->tail, node, NULL)) {
+            return;
+        }
+        while ((next = (mcs_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next)) == NULL) {
+            cpu_pause();
+        }
+    }
+    atomic_store_release(&next->locked, status);
+}
+
+static inline void hmcs_release(hmcs_level_t *level, mcs_node_t *node)
+{
+    mcs_node_t *next;
+    uint32_t count;
+
+    if (level->parent == NULL) {
+        hmcs_pass(level, node, HMCS_COHORT_START);
+        return;
+    }
+
+    /* Keep the parent within the cohort while under the threshold */
+    count = node->locked;
+    if (count < level->threshold) {
+        next = (mcs_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+        if (next != NULL) {
+            atomic_store_release(&next->locked, count + 1);
+            return;
+        }
+    }
+
+    hmcs_release(level->parent, &level->node);
+    hmcs_pass(level, node, HMCS_ACQUIRE_PARENT);
+}
+
+static inline void hmcs_lock(hmcs_lock_t *lock, hmcs_node_t *node)
+{
+    if (hmcs_thread_cpu == HMCS_CPU_UNKNOWN) {
+        hmcs_thread_cpu = cas_current_cpu();
+    }
+    node->leaf = lock->leaf_of_cpu[hmcs_thread_cpu % lock->num_cpus];
+    hmcs_acquire(node->leaf, &node->qnode);
+}
+
+static inline void hmcs_unlock(hmcs_lock_t *lock, hmcs_node_t *node)
+{
+    (void)lock;
+    hmcs_release(node->leaf, &node->qnode);
+}
+
+#endif /* CAS_LOCK_HMCSLOCK_H */
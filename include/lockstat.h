@@ -0,0 +1,75 @@
+#ifndef CAS_LOCK_LOCKSTAT_H
+#define CAS_LOCK_LOCKSTAT_H
+
+#include "atomic.h"
+#include "platform.h"
+
+/*
+ * Hold-time estimator for the FIFO locks' admission-control queries.
+ *
+ * Every LOCK_STAT_SAMPLE-th acquisition (by acquisition sequence number)
+ * timestamps itself and folds its hold time into an EWMA with weight 1/8
+ * on release, so the common path pays one mask test and only sampled
+ * holders read the clock.  All updates are made by the current holder;
+ * readers just load hold_ns.  A newcomer's wait is then roughly the
+ * number of threads ahead of it times hold_ns.
+ */
+#define LOCK_STAT_SAMPLE 16     /* must be a power of two */
+#define LOCK_STAT_SHIFT  3      /* EWMA weight 1/8 */
+
+typedef struct {
+    uint64_t sample_start;          /* clock at the sampled acquisition */
+    volatile uint32_t hold_ns;      /* EWMA of hold time, 0 until sampled */
+    uint32_t sampling;              /* 1 while a sample is in flight */
+} lock_stat_t;
+
+#define LOCK_STAT_INITIALIZER {0, 0, 0}
+
+static inline void lock_stat_init(lock_stat_t *stat)
+{
+    stat->sample_start = 0;
+    atomic_store(&stat->hold_ns, 0);
+    stat->sampling = 0;
+}
+
+/* Called by the new holder with its acquisition sequence number */
+static inline void lock_stat_acquired(lock_stat_t *stat, uint32_t seq)
+{
+    if ((seq & (LOCK_STAT_SAMPLE - 1)) != 0) {
+        return;
+    }
+    stat->sample_start = cas_clock_ns();
+    stat->sampling = 1;
+}
+
+/* Called by the holder just before it hands the lock on */
+static inline void lock_stat_releasing(lock_stat_t *stat)
+{
+    uint64_t held;
+    uint32_t ewma;
+
+    if (!stat->sampling) {
+        return;
+    }
+    stat->sampling = 0;
+
+    held = cas_clock_ns() - stat->sample_start;
+    if (held > UINT32_MAX) {
+        held = UINT32_MAX;
+    }
+    ewma = atomic_load(&stat->hold_ns);
+    if (ewma == 0) {
+        ewma = (uint32_t)held;
+    } else {
+        ewma = (uint32_t)((int64_t)ewma + (((int64_t)held - (int64_t)ewma) >> LOCK_STAT_SHIFT));
+    }
+    atomic_store(&stat->hold_ns, ewma ? ewma : 1);
+}
+
+/* Estimated time until a thread arriving now would own the lock */
+static inline uint64_t lock_stat_estimate_ns(const lock_stat_t *stat, uint32_t queue_length)
+{
+    return (uint64_t)queue_length * atomic_load(&stat->hold_ns);
+}
+
+#endif /* CAS_LOCK_LOCKSTAT_H */
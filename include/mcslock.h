@@ -2,6 +2,8 @@
 #define CAS_LOCK_MCSLOCK_H
 
 #include "atomic.h"
+#include "lockstat.h"
+#include "platform.h"
 #include <stdlib.h>
 
 /*
@@ -27,7 +29,7 @@ typedef struct {
 /* Initialize MCS lock */
 static inline void mcs_init(mcs_lock_t *lock)
 {
-    atomic_store((volatile uint32_t *)&lock->tail, 0);
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
 }
 
 /* Initialize a thread's MCS node */
@@ -38,8 +40,8 @@ static inline void mcs_node_init(mcs_node_t *node)
     node->prev = NULL;
 }
 
-/* Acquire MCS lock */
-static inline void mcs_lock(mcs_lock_t *lock, mcs_node_t *node)
+/* Acquire MCS lock with a caller-managed node */
+static inline void mcs_lock_node(mcs_lock_t *lock, mcs_node_t *node)
 {
     mcs_node_t *prev;
 
@@ -48,40 +50,39 @@ static inline void mcs_lock(mcs_lock_t *lock, mcs_node_t *node)
     node->locked = 0;
 
     /* Atomically swap our node as the tail, getting previous tail */
-    prev = (mcs_node_t *)atomic_xchg((volatile uint32_t *)&lock->tail, (uint32_t)node);
+    prev = (mcs_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, node);
 
     if (prev != NULL) {
         /* There was a previous node, add ourselves to queue */
         node->locked = 1;  /* We need to wait */
-        atomic_store_release((volatile uint32_t *)&prev->next, (uint32_t)node);
+        atomic_store_ptr_release((void *volatile *)&prev->next, node);
 
         /* Spin on our own locked flag */
         while (atomic_load_acquire(&node->locked) != 0) {
+            CAS_LOCK_POLL_HOOK();
             cpu_pause();
         }
     }
     /* Otherwise, lock was free, we have it */
 }
 
-/* Release MCS lock */
-static inline void mcs_unlock(mcs_lock_t *lock, mcs_node_t *node)
+/* Release MCS lock taken with mcs_lock_node() */
+static inline void mcs_unlock_node(mcs_lock_t *lock, mcs_node_t *node)
 {
     mcs_node_t *next;
 
     /* Check if there's a successor */
-    next = (mcs_node_t *)atomic_load((volatile uint32_t *)&node->next);
+    next = (mcs_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
 
     if (next == NULL) {
         /* Try to set tail back to NULL */
-        mcs_node_t *old_tail = node;
-        if (atomic_cmpxchg_bool((volatile uint32_t *)&lock->tail,
-                                (uint32_t)old_tail, 0)) {
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, node, NULL)) {
             /* Successfully unset tail, no one is waiting */
             return;
         }
 
         /* Someone added themselves to queue, wait for them to set next */
-        while ((next = (mcs_node_t *)atomic_load((volatile uint32_t *)&node->next)) == NULL) {
+        while ((next = (mcs_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next)) == NULL) {
             cpu_pause();
         }
     }
@@ -90,59 +91,712 @@ static inline void mcs_unlock(mcs_lock_t *lock, mcs_node_t *node)
     atomic_store_release(&next->locked, 0);
 }
 
+/*
+ * Implicit-node MCS API
+ * Each thread owns a small stack of cache-line padded nodes, one per lock
+ * it may hold at once (like qspinlock's per-CPU nodes), so callers need
+ * not manage mcs_node_t.  Locks may be released in any order; nesting
+ * deeper than MCS_MAX_NESTING aborts.  The stack is a weak TLS symbol so
+ * all translation units share it.
+ */
+#define MCS_MAX_NESTING 4
+
+typedef struct {
+    mcs_node_t node;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) mcs_tls_node_t;
+
+typedef struct {
+    mcs_tls_node_t nodes[MCS_MAX_NESTING];
+    mcs_lock_t *locks[MCS_MAX_NESTING];     /* lock each node is used for */
+    uint32_t depth;
+} mcs_tls_t;
+
+__attribute__((weak)) __thread mcs_tls_t mcs_tls;
+
+/* Acquire MCS lock using the calling thread's node stack */
+static inline void mcs_lock(mcs_lock_t *lock)
+{
+    mcs_tls_t *tls = &mcs_tls;
+    uint32_t depth = tls->depth;
+
+    if (depth >= MCS_MAX_NESTING) {
+        fprintf(stderr, "mcs_lock: more than %d MCS locks held\n", MCS_MAX_NESTING);
+        abort();
+    }
+    tls->locks[depth] = lock;
+    tls->depth = depth + 1;
+    mcs_lock_node(lock, &tls->nodes[depth].node);
+}
+
+/* Release MCS lock taken with mcs_lock() */
+static inline void mcs_unlock(mcs_lock_t *lock)
+{
+    mcs_tls_t *tls = &mcs_tls;
+    uint32_t i = tls->depth;
+
+    /* Usually the most recent acquisition */
+    while (i > 0 && tls->locks[i - 1] != lock) {
+        i--;
+    }
+    if (i == 0) {
+        fprintf(stderr, "mcs_unlock: lock %p not held by this thread\n", (void *)lock);
+        abort();
+    }
+    i--;
+
+    mcs_unlock_node(lock, &tls->nodes[i].node);
+    tls->locks[i] = NULL;
+
+    /* Pop the released slot and any holes left by out-of-order releases */
+    while (tls->depth > 0 && tls->locks[tls->depth - 1] == NULL) {
+        tls->depth--;
+    }
+}
+
+/*
+ * MCS Lock with queue statistics
+ * Opt-in variant for callers that want mcs_queue_length() and
+ * mcs_estimated_wait_ns().  An MCS queue has no counter to read its
+ * depth from, so every acquire also bumps an enqueue counter on the
+ * tail's line and every release a dequeue counter; plain mcs_lock_t
+ * users do not pay for either.
+ */
+typedef struct {
+    mcs_lock_t lock;
+    volatile uint32_t enqueued;     /* acquisitions started */
+    volatile uint32_t dequeued;     /* releases, written by the holder only */
+    lock_stat_t stat;               /* hold-time EWMA for wait estimates */
+} mcs_stat_lock_t;
+
+#define MCS_STAT_LOCK_INITIALIZER {MCS_LOCK_INITIALIZER, 0, 0, LOCK_STAT_INITIALIZER}
+
+static inline void mcs_stat_init(mcs_stat_lock_t *lock)
+{
+    mcs_init(&lock->lock);
+    atomic_store(&lock->enqueued, 0);
+    atomic_store(&lock->dequeued, 0);
+    lock_stat_init(&lock->stat);
+}
+
+static inline void mcs_stat_lock(mcs_stat_lock_t *lock, mcs_node_t *node)
+{
+    atomic_fetch_add(&lock->enqueued, 1);
+    mcs_lock_node(&lock->lock, node);
+    lock_stat_acquired(&lock->stat, lock->dequeued);
+}
+
+static inline void mcs_stat_unlock(mcs_stat_lock_t *lock, mcs_node_t *node)
+{
+    lock_stat_releasing(&lock->stat);
+    atomic_store(&lock->dequeued, lock->dequeued + 1);
+    mcs_unlock_node(&lock->lock, node);
+}
+
+/* Threads holding or waiting for the lock, i.e. ahead of a newcomer */
+static inline uint32_t mcs_queue_length(mcs_stat_lock_t *lock)
+{
+    return atomic_load(&lock->enqueued) - atomic_load(&lock->dequeued);
+}
+
+/* Estimated wait for a newcomer, 0 until a hold time has been sampled */
+static inline uint64_t mcs_estimated_wait_ns(mcs_stat_lock_t *lock)
+{
+    return lock_stat_estimate_ns(&lock->stat, mcs_queue_length(lock));
+}
+
+/*
+ * MCS-park
+ * MCS for oversubscribed machines: a waiter spins on its node for
+ * MCS_PARK_SPINS polls, then parks on the node's state word so the CPU
+ * goes to the holder or to the waiters ahead of it instead of burning a
+ * time slice.  The releaser swaps GRANTED into its successor's state and
+ * makes the wake-up syscall only if the old state says the successor
+ * actually parked, so the spinning handoff costs the same as plain MCS.
+ */
+#ifndef MCS_PARK_SPINS
+#define MCS_PARK_SPINS 2048
+#endif
+
+#define MCS_PARK_GRANTED 0
+#define MCS_PARK_WAITING 1
+#define MCS_PARK_PARKED  2
+
+typedef struct mcs_park_node {
+    struct mcs_park_node *volatile next;
+    volatile uint32_t state;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) mcs_park_node_t;
+
+typedef struct {
+    mcs_park_node_t *volatile tail;
+} mcs_park_lock_t;
+
+#define MCS_PARK_LOCK_INITIALIZER {NULL}
+
+static inline void mcs_park_init(mcs_park_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+}
+
+static inline void mcs_park_lock(mcs_park_lock_t *lock, mcs_park_node_t *node)
+{
+    mcs_park_node_t *prev;
+    uint32_t spins = MCS_PARK_SPINS;
+
+    node->next = NULL;
+    node->state = MCS_PARK_WAITING;
+
+    prev = (mcs_park_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, node);
+    if (prev == NULL) {
+        return;
+    }
+    atomic_store_ptr_release((void *volatile *)&prev->next, node);
+
+    while (atomic_load_acquire(&node->state) != MCS_PARK_GRANTED) {
+        if (spins > 0) {
+            spins--;
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+            continue;
+        }
+        /* Announce the park; fails harmlessly if granted or already parked */
+        atomic_cmpxchg_bool(&node->state, MCS_PARK_WAITING, MCS_PARK_PARKED);
+        cas_park(&node->state, MCS_PARK_PARKED);
+    }
+}
+
+static inline void mcs_park_unlock(mcs_park_lock_t *lock, mcs_park_node_t *node)
+{
+    mcs_park_node_t *next = (mcs_park_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+
+    if (next == NULL) {
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, node, NULL)) {
+            return;
+        }
+        while ((next = (mcs_park_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next)) == NULL) {
+            cpu_pause();
+        }
+    }
+
+    /*
+     * A parked successor may wake spuriously, see the grant and reuse its
+     * node before the wake-up below; waking a stale address is harmless
+     * because every parker re-checks its word.
+     */
+    if (atomic_xchg(&next->state, MCS_PARK_GRANTED) == MCS_PARK_PARKED) {
+        cas_unpark(&next->state, 1);
+    }
+}
+
+/*
+ * Malthusian MCS (Dice, MCSCR)
+ * When more threads wait than it takes to keep the lock busy, the extra
+ * waiters only add cache pressure.  On release, if the successor already
+ * has a successor of its own, the holder culls the successor: unlinks
+ * it, appends it to a passive list and marks it passive, upon which it
+ * parks.  The active queue thus shrinks to the holder and about two
+ * waiters.  Passive waiters come back when the active queue runs dry, and
+ * every MALTH_REINTEGRATE_PERIOD releases the oldest one is granted the
+ * lock directly, which bounds how long a culled waiter stays out.  Active
+ * waiters spin then park as in MCS-park, so a queue that outgrows the
+ * CPUs before the holder gets to cull it does not convoy either.
+ *
+ * The passive list is only touched by the holder, so it needs no atomics.
+ */
+#ifndef MALTH_REINTEGRATE_PERIOD
+#define MALTH_REINTEGRATE_PERIOD 1024
+#endif
+
+#define MALTH_GRANTED 0
+#define MALTH_WAITING 1
+#define MALTH_PASSIVE 2
+#define MALTH_PARKED  3
+
+typedef struct malth_node {
+    struct malth_node *volatile next;
+    volatile uint32_t state;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) malth_node_t;
+
+typedef struct {
+    malth_node_t *volatile tail;
+    malth_node_t *passive_head;     /* oldest culled waiter */
+    malth_node_t *passive_tail;
+    uint32_t releases;
+} malth_lock_t;
+
+#define MALTH_LOCK_INITIALIZER {NULL, NULL, NULL, 0}
+
+static inline void malth_init(malth_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+    lock->passive_head = NULL;
+    lock->passive_tail = NULL;
+    lock->releases = 0;
+}
+
+static inline void malth_lock(malth_lock_t *lock, malth_node_t *node)
+{
+    malth_node_t *prev;
+    uint32_t state;
+    uint32_t spins = MCS_PARK_SPINS;
+
+    node->next = NULL;
+    node->state = MALTH_WAITING;
+
+    prev = (malth_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, node);
+    if (prev == NULL) {
+        return;
+    }
+    atomic_store_ptr_release((void *volatile *)&prev->next, node);
+
+    while ((state = atomic_load_acquire(&node->state)) != MALTH_GRANTED) {
+        if (state == MALTH_WAITING) {
+            if (spins > 0) {
+                spins--;
+                CAS_LOCK_POLL_HOOK();
+                cpu_pause();
+                continue;
+            }
+            if (!atomic_cmpxchg_bool(&node->state, MALTH_WAITING, MALTH_PARKED)) {
+                continue;
+            }
+            state = MALTH_PARKED;
+        }
+        /* Passive or parked: sleep until the state word changes */
+        cas_park(&node->state, state);
+    }
+}
+
+/* Take the oldest passive waiter; the caller links it back in */
+static inline malth_node_t *malth_passive_pop(malth_lock_t *lock)
+{
+    malth_node_t *node = lock->passive_head;
+
+    if (node != NULL) {
+        lock->passive_head = node->next;
+        if (lock->passive_head == NULL) {
+            lock->passive_tail = NULL;
+        }
+        node->next = NULL;
+    }
+    return node;
+}
+
+static inline void malth_grant(malth_node_t *node)
+{
+    if (atomic_xchg(&node->state, MALTH_GRANTED) != MALTH_WAITING) {
+        cas_unpark(&node->state, 1);
+    }
+}
+
+static inline void malth_unlock(malth_lock_t *lock, malth_node_t *node)
+{
+    malth_node_t *next = (malth_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+    malth_node_t *passive, *after;
+
+    if (next == NULL) {
+        /* Active queue empty: a passive waiter, if any, becomes the tail */
+        passive = malth_passive_pop(lock);
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, node, passive)) {
+            if (passive != NULL) {
+                malth_grant(passive);
+            }
+            return;
+        }
+        while ((next = (malth_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next)) == NULL) {
+            cpu_pause();
+        }
+        if (passive != NULL) {
+            passive->next = next;
+            malth_grant(passive);
+            return;
+        }
+    }
+
+    if (++lock->releases % MALTH_REINTEGRATE_PERIOD == 0 &&
+        (passive = malth_passive_pop(lock)) != NULL) {
+        /* Long-term fairness: the oldest passive waiter goes next */
+        passive->next = next;
+        malth_grant(passive);
+        return;
+    }
+
+    /* Surplus waiters: cull the successor and grant the one behind it */
+    after = (malth_node_t *)atomic_load_ptr_acquire((void *volatile *)&next->next);
+    if (after != NULL) {
+        next->next = NULL;
+        if (lock->passive_tail != NULL) {
+            lock->passive_tail->next = next;
+        } else {
+            lock->passive_head = next;
+        }
+        lock->passive_tail = next;
+        atomic_store_release(&next->state, MALTH_PASSIVE);
+        next = after;
+    }
+    malth_grant(next);
+}
+
+/*
+ * Hemlock (Dice and Kogan)
+ * A one-word queue lock without queue nodes.  The tail names the last
+ * waiter's per-thread grant word; a newcomer swaps itself in and spins on
+ * its predecessor's grant word until that holds the address of this lock.
+ * The releaser then waits until the successor has cleared the word again,
+ * so one grant word serves every lock a thread holds or waits on.  The
+ * word lives in a weak TLS symbol shared by all translation units.
+ */
+typedef struct {
+    void *volatile grant;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) hemlock_grant_t;
+
+typedef struct {
+    hemlock_grant_t *volatile tail;
+} hemlock_t;
+
+#define HEMLOCK_INITIALIZER {NULL}
+
+__attribute__((weak)) __thread hemlock_grant_t hemlock_self;
+
+static inline void hemlock_init(hemlock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int hemlock_trylock(hemlock_t *lock)
+{
+    return atomic_load_ptr((void *volatile *)&lock->tail) == NULL &&
+           atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, NULL, &hemlock_self);
+}
+
+static inline void hemlock_lock(hemlock_t *lock)
+{
+    hemlock_grant_t *pred;
+
+    pred = (hemlock_grant_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, &hemlock_self);
+    if (pred == NULL) {
+        return;
+    }
+
+    while (atomic_load_ptr_acquire((void *volatile *)&pred->grant) != lock) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+    /* Acknowledge, freeing the predecessor's word for its next release */
+    atomic_store_ptr_release((void *volatile *)&pred->grant, NULL);
+}
+
+static inline void hemlock_unlock(hemlock_t *lock)
+{
+    if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, &hemlock_self, NULL)) {
+        return;
+    }
+
+    atomic_store_ptr_release((void *volatile *)&hemlock_self.grant, lock);
+    while (atomic_load_ptr_acquire((void *volatile *)&hemlock_self.grant) != NULL) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+}
+
 /*
  * CLH Lock (Craig, Landin, and Hagersten)
- * Similar to MCS but with a different spinning strategy
+ * Waiters form an implicit queue by swapping their node into the tail and
+ * spinning on the predecessor's node.  On unlock a thread hands its own
+ * node to the successor and takes over the predecessor's node, so every
+ * thread always owns exactly one node and nothing is allocated.
+ *
+ * Callers keep a clh_node_t pointer per thread and pass its address to
+ * every lock/unlock; after unlock it points at a different node.  A NULL
+ * tail stands for the lock's embedded node, so the initializer is
+ * constant.  Nodes, including embedded ones, migrate between threads and
+ * locks: neither a CLH lock nor a thread's initial node may be freed
+ * while threads still use CLH locks, so give them static storage.
  */
 
 typedef struct clh_node {
-    volatile struct clh_node *prev;
     volatile uint32_t locked;
-} clh_node_t;
+    struct clh_node *prev;          /* node to take over on unlock */
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) clh_node_t;
 
 typedef struct {
-    volatile clh_node_t *tail;
+    clh_node_t *volatile tail;      /* NULL until first use: means &dummy */
+    clh_node_t dummy;
 } clh_lock_t;
 
-#define CLH_LOCK_INITIALIZER {NULL}
-#define CLH_NODE_INITIALIZER {NULL, 0}
+#define CLH_NODE_INITIALIZER {0, NULL}
+#define CLH_LOCK_INITIALIZER {NULL, CLH_NODE_INITIALIZER}
 
+/*
+ * Initialize CLH lock.  A used lock may only be re-initialized while idle
+ * and if every thread that used it restarts from a fresh node, since one
+ * of them may now own the embedded node.
+ */
 static inline void clh_init(clh_lock_t *lock)
 {
-    clh_node_t *dummy = (clh_node_t *)malloc(sizeof(clh_node_t));
-    dummy->prev = NULL;
-    dummy->locked = 0;
-    atomic_store((volatile uint32_t *)&lock->tail, (uint32_t)dummy);
+    lock->dummy.locked = 0;
+    lock->dummy.prev = NULL;
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
 }
 
+/* Initialize a thread's initial CLH node */
 static inline void clh_node_init(clh_node_t *node)
 {
     node->locked = 0;
     node->prev = NULL;
 }
 
-static inline void clh_lock(clh_lock_t *lock, clh_node_t *node)
+/* Acquire CLH lock with the node *node currently owned by the caller */
+static inline void clh_lock(clh_lock_t *lock, clh_node_t **node)
 {
+    clh_node_t *me = *node;
     clh_node_t *prev;
 
-    node->locked = 1;
-    prev = (clh_node_t *)atomic_xchg((volatile uint32_t *)&lock->tail, (uint32_t)node);
-    node->prev = prev;
+    me->locked = 1;
+    prev = (clh_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, me);
+    if (prev == NULL) {
+        prev = &lock->dummy;
+    }
+    me->prev = prev;
 
     /* Spin on predecessor's locked flag */
     while (atomic_load_acquire(&prev->locked) != 0) {
+        CAS_LOCK_POLL_HOOK();
         cpu_pause();
     }
 }
 
-static inline void clh_unlock(clh_lock_t *lock, clh_node_t *node)
+/* Release CLH lock; *node is replaced by the predecessor's node */
+static inline void clh_unlock(clh_lock_t *lock, clh_node_t **node)
 {
-    clh_node_t *prev = node->prev;
+    clh_node_t *me = *node;
+    clh_node_t *prev = me->prev;
+
+    (void)lock;
+
+    /* Our node now belongs to the successor (or stays as the tail) */
+    atomic_store_release(&me->locked, 0);
+    *node = prev;
+}
+
+/*
+ * Abortable queue locks
+ * Waiters give up once timeout_ns has passed, for callers with deadlines.
+ * Both locks take the address of a per-thread node pointer (NULL to start):
+ * a node is allocated on demand, and when an aborted or released node may
+ * still be reached by another thread its ownership passes to that thread,
+ * which frees it, and *node is reset to NULL.  Free the node left in
+ * *node with the matching *_node_free() when the thread is done.
+ * The deadline is checked every MCS_TRY_CLOCK_POLLS polls.
+ */
+#define MCS_TRY_CLOCK_POLLS 64
 
-    /* Signal that we're done */
-    atomic_store_release(&node->locked, 0);
+/*
+ * MCS-try
+ * A timed-out waiter marks its node abandoned and leaves it in the queue;
+ * the releaser skips abandoned nodes when passing the lock on, unlinks
+ * them and frees them.  Unlock cost grows with the number of abandoned
+ * nodes directly behind the holder.
+ */
+#define MCS_TRY_WAITING   0
+#define MCS_TRY_GRANTED   1
+#define MCS_TRY_ABANDONED 2
+
+typedef struct mcs_try_node {
+    struct mcs_try_node *volatile next;
+    volatile uint32_t state;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) mcs_try_node_t;
+
+typedef struct {
+    mcs_try_node_t *volatile tail;
+} mcs_try_lock_t;
+
+#define MCS_TRY_LOCK_INITIALIZER {NULL}
+
+static inline void mcs_try_init(mcs_try_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+}
+
+static inline void mcs_try_node_free(mcs_try_node_t *node)
+{
+    cas_default_free(node);
+}
+
+/* Returns 1 with the lock held, 0 if timeout_ns passed first */
+static inline int mcs_try_lock(mcs_try_lock_t *lock, mcs_try_node_t **node,
+                               uint64_t timeout_ns)
+{
+    mcs_try_node_t *me = *node;
+    mcs_try_node_t *prev;
+    uint64_t start;
+    uint32_t polls = 0;
 
-    /* Must keep node for GC - in practice, use a persistent node per thread */
+    if (me == NULL) {
+        me = (mcs_try_node_t *)cas_default_alloc(sizeof(*me), CAS_LOCK_CACHELINE);
+        if (me == NULL) {
+            abort();
+        }
+        *node = me;
+    }
+    me->next = NULL;
+    me->state = MCS_TRY_WAITING;
+
+    prev = (mcs_try_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, me);
+    if (prev == NULL) {
+        return 1;
+    }
+
+    /* prev stays allocated until its releaser has seen this link */
+    atomic_store_ptr_release((void *volatile *)&prev->next, me);
+
+    start = cas_clock_ns();
+    while (atomic_load_acquire(&me->state) != MCS_TRY_GRANTED) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+        if (++polls % MCS_TRY_CLOCK_POLLS == 0 && cas_clock_ns() - start >= timeout_ns) {
+            if (atomic_cmpxchg_bool(&me->state, MCS_TRY_WAITING, MCS_TRY_ABANDONED)) {
+                /* The releaser that skips the node frees it */
+                *node = NULL;
+                return 0;
+            }
+            /* Lost the race to a grant: we hold the lock */
+            break;
+        }
+    }
+    return 1;
+}
+
+static inline void mcs_try_unlock(mcs_try_lock_t *lock, mcs_try_node_t *node)
+{
+    mcs_try_node_t *cur = node;
+    mcs_try_node_t *next;
+
+    for (;;) {
+        next = (mcs_try_node_t *)atomic_load_ptr_acquire((void *volatile *)&cur->next);
+        if (next == NULL) {
+            if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, cur, NULL)) {
+                break;
+            }
+            /* A waiter is linking in behind cur */
+            while ((next = (mcs_try_node_t *)atomic_load_ptr_acquire((void *volatile *)&cur->next)) == NULL) {
+                cpu_pause();
+            }
+        }
+
+        /* Nobody can reach an abandoned node once its successor is known */
+        if (cur != node) {
+            mcs_try_node_free(cur);
+        }
+
+        if (atomic_cmpxchg_bool(&next->state, MCS_TRY_WAITING, MCS_TRY_GRANTED)) {
+            return;
+        }
+
+        /* next was abandoned; pass the lock on from its position instead */
+        cur = next;
+    }
+
+    if (cur != node) {
+        mcs_try_node_free(cur);
+    }
+}
+
+/*
+ * CLH-try (Scott's timeout lock as presented by Herlihy and Shavit)
+ * A node's pred field is NULL while its owner waits or holds the lock,
+ * CLH_TRY_AVAILABLE once released, and the owner's predecessor once
+ * abandoned, so a waiter whose predecessor times out simply moves on to
+ * spin on the node before it.  An aborting or releasing thread that is
+ * still the tail swings the tail back and keeps its node; otherwise the
+ * one successor that will read the node frees it.
+ */
+typedef struct clh_try_node {
+    struct clh_try_node *volatile pred;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) clh_try_node_t;
+
+typedef struct {
+    clh_try_node_t *volatile tail;
+} clh_try_lock_t;
+
+#define CLH_TRY_LOCK_INITIALIZER {NULL}
+
+/* Shared release marker; weak so all translation units agree on it */
+__attribute__((weak)) clh_try_node_t clh_try_available;
+#define CLH_TRY_AVAILABLE (&clh_try_available)
+
+static inline void clh_try_init(clh_try_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+}
+
+static inline void clh_try_node_free(clh_try_node_t *node)
+{
+    cas_default_free(node);
+}
+
+/* Returns 1 with the lock held, 0 if timeout_ns passed first */
+static inline int clh_try_lock(clh_try_lock_t *lock, clh_try_node_t **node,
+                               uint64_t timeout_ns)
+{
+    clh_try_node_t *me = *node;
+    clh_try_node_t *pred, *pred_pred;
+    uint64_t start;
+    uint32_t polls = 0;
+
+    if (me == NULL) {
+        me = (clh_try_node_t *)cas_default_alloc(sizeof(*me), CAS_LOCK_CACHELINE);
+        if (me == NULL) {
+            abort();
+        }
+        *node = me;
+    }
+    me->pred = NULL;
+
+    pred = (clh_try_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, me);
+    if (pred == NULL) {
+        return 1;
+    }
+
+    start = cas_clock_ns();
+    for (;;) {
+        pred_pred = (clh_try_node_t *)atomic_load_ptr_acquire((void *volatile *)&pred->pred);
+        if (pred_pred == CLH_TRY_AVAILABLE) {
+            clh_try_node_free(pred);
+            return 1;
+        }
+        if (pred_pred != NULL) {
+            /* Predecessor timed out: wait behind its predecessor instead */
+            clh_try_node_free(pred);
+            pred = pred_pred;
+            continue;
+        }
+
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+        if (++polls % MCS_TRY_CLOCK_POLLS == 0 && cas_clock_ns() - start >= timeout_ns) {
+            break;
+        }
+    }
+
+    /* Timed out: unlink, or leave a forwarding pointer for our successor */
+    if (!atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, me, pred)) {
+        atomic_store_ptr_release((void *volatile *)&me->pred, pred);
+        *node = NULL;
+    }
+    return 0;
+}
+
+static inline void clh_try_unlock(clh_try_lock_t *lock, clh_try_node_t **node)
+{
+    clh_try_node_t *me = *node;
+
+    if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, me, NULL)) {
+        return;
+    }
+    /* The successor frees the node after seeing the marker */
+    atomic_store_ptr_release((void *volatile *)&me->pred, CLH_TRY_AVAILABLE);
+    *node = NULL;
 }
 
 #endif /* CAS_LOCK_MCSLOCK_H */
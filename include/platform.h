@@ -0,0 +1,198 @@
+#ifndef CAS_LOCK_PLATFORM_H
+#define CAS_LOCK_PLATFORM_H
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+/*
+ * OS-facing helpers shared by the locks that need more than atomics:
+ * clocks and sleeps for calibration and wait accounting, CPU counts for
+ * sizing per-CPU arrays, NUMA placement, parking for blocking waiters,
+ * and the allocator hook those arrays are carved from.
+ */
+
+/* Monotonic clock in nanoseconds (vDSO on Linux, no syscall) */
+static inline uint64_t cas_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Sleep for about ns nanoseconds */
+static inline void cas_sleep_ns(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    nanosleep(&ts, NULL);
+}
+
+/* Number of configured CPUs (not just online ones), at least 1 */
+static inline uint32_t cas_num_cpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_CONF);
+    return n > 0 ? (uint32_t)n : 1;
+}
+
+/* NUMA node of the CPU the caller is running on, 0 if unknown */
+static inline uint32_t cas_numa_node(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+/*
+ * CPU the caller is running on, 0 if unknown.  On glibc this is
+ * sched_getcpu(), read from the thread's rseq area or the vDSO, which is
+ * cheap enough for per-acquire use.  <sched.h> only declares it under
+ * _GNU_SOURCE, so declare it ourselves otherwise.
+ */
+#if defined(__linux__) && defined(__GLIBC__) && !defined(_GNU_SOURCE)
+extern int sched_getcpu(void);
+#endif
+
+static inline uint32_t cas_current_cpu(void)
+{
+#if defined(__linux__) && defined(__GLIBC__)
+    int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return (uint32_t)cpu;
+    }
+#elif defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return cpu;
+    }
+#endif
+    return 0;
+}
+
+/*
+ * CPU topology from /sys/devices/system/cpu.  cas_cpu_group() names the
+ * group of CPUs sharing a level with `cpu` by its lowest-numbered member
+ * (the first entry of the sysfs CPU list), or returns `cpu` itself when
+ * the level is not reported.
+ */
+#define CAS_TOPO_SMT     0      /* hardware threads of one core */
+#define CAS_TOPO_L3      1      /* CPUs sharing a last-level cache / CCX */
+#define CAS_TOPO_PACKAGE 2      /* socket */
+#define CAS_TOPO_LEVELS  3
+
+static inline int cas_read_sysfs_uint(const char *path, uint32_t *value)
+{
+    FILE *f = fopen(path, "r");
+    int ok;
+
+    if (f == NULL) {
+        return 0;
+    }
+    ok = fscanf(f, "%u", value) == 1;
+    fclose(f);
+    return ok;
+}
+
+static inline uint32_t cas_cpu_group(uint32_t cpu, int level)
+{
+    char path[128];
+    uint32_t value, index;
+
+    switch (level) {
+    case CAS_TOPO_SMT:
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+        break;
+    case CAS_TOPO_L3:
+        for (index = 0; index < 16; index++) {
+            snprintf(path, sizeof(path),
+                     "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+            if (!cas_read_sysfs_uint(path, &value)) {
+                return cpu;
+            }
+            if (value == 3) {
+                break;
+            }
+        }
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+        break;
+    case CAS_TOPO_PACKAGE:
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%u/topology/core_siblings_list", cpu);
+        break;
+    default:
+        return cpu;
+    }
+
+    return cas_read_sysfs_uint(path, &value) ? value : cpu;
+}
+
+/*
+ * Parking on a 32-bit word.  cas_park() sleeps while *addr == expected
+ * and may return spuriously, so callers re-check in a loop; cas_unpark()
+ * wakes up to `count` threads parked on addr.  Without futexes parking
+ * degrades to yielding the CPU.
+ */
+static inline void cas_park(volatile uint32_t *addr, uint32_t expected)
+{
+#if defined(__linux__) && defined(SYS_futex)
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    (void)addr;
+    (void)expected;
+    sched_yield();
+#endif
+}
+
+static inline void cas_unpark(volatile uint32_t *addr, int count)
+{
+#if defined(__linux__) && defined(SYS_futex)
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    (void)addr;
+    (void)count;
+#endif
+}
+
+/* Smallest power of two >= n (n >= 1) */
+static inline uint32_t cas_pow2_roundup(uint32_t n)
+{
+    uint32_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/*
+ * Allocator hook for lock-owned arrays.  alloc must return memory aligned
+ * to `align` (a power of two) or NULL; free releases it.
+ */
+typedef void *(*cas_alloc_fn)(size_t size, size_t align);
+typedef void (*cas_free_fn)(void *ptr);
+
+static inline void *cas_default_alloc(size_t size, size_t align)
+{
+    void *ptr;
+    return posix_memalign(&ptr, align, size) == 0 ? ptr : NULL;
+}
+
+static inline void cas_default_free(void *ptr)
+{
+    free(ptr);
+}
+
+#endif /* CAS_LOCK_PLATFORM_H */
@@ -0,0 +1,123 @@
+#ifndef CAS_LOCK_PRIOLOCK_H
+#define CAS_LOCK_PRIOLOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+#include "mcslock.h"
+
+/*
+ * Two-class Priority Lock
+ * High-priority and normal threads queue on separate MCS locks; only the
+ * head of each queue competes for the lock word, so at most two threads
+ * spin on it.  While any high-priority thread is pending, the normal head
+ * stands back, so a release goes to the high class whenever it has a
+ * waiter.  To bound starvation, after PRIO_MAX_HIGH_STREAK high handoffs
+ * in a row with a normal head waiting, the next handoff is reserved for
+ * the normal head.
+ *
+ * Queue nodes only live until their owner reaches the lock word, so they
+ * are kept on the stack and unlock needs no node.
+ */
+#ifndef PRIO_MAX_HIGH_STREAK
+#define PRIO_MAX_HIGH_STREAK 16
+#endif
+
+#define PRIO_NORMAL 0
+#define PRIO_HIGH   1
+
+typedef struct {
+    volatile uint32_t locked;
+    volatile uint32_t high_pending;     /* high threads queued or at the head */
+    volatile uint32_t normal_waiting;   /* the normal head wants the lock */
+    volatile uint32_t normal_turn;      /* next handoff reserved for normal */
+    uint32_t holder_class;              /* written by the holder */
+    uint32_t high_streak;
+    mcs_lock_t queue[2];                /* indexed by PRIO_NORMAL/PRIO_HIGH */
+} prio_lock_t;
+
+#define PRIO_LOCK_INITIALIZER {0, 0, 0, 0, 0, 0, {MCS_LOCK_INITIALIZER, MCS_LOCK_INITIALIZER}}
+
+static inline void prio_init(prio_lock_t *lock)
+{
+    atomic_store(&lock->locked, 0);
+    atomic_store(&lock->high_pending, 0);
+    atomic_store(&lock->normal_waiting, 0);
+    atomic_store(&lock->normal_turn, 0);
+    lock->holder_class = PRIO_NORMAL;
+    lock->high_streak = 0;
+    mcs_init(&lock->queue[PRIO_NORMAL]);
+    mcs_init(&lock->queue[PRIO_HIGH]);
+}
+
+static inline void prio_lock_high(prio_lock_t *lock)
+{
+    mcs_node_t node;
+
+    atomic_inc(&lock->high_pending);
+    mcs_lock_node(&lock->queue[PRIO_HIGH], &node);
+
+    for (;;) {
+        if (atomic_load(&lock->normal_turn) == 0 && atomic_load(&lock->locked) == 0 &&
+            atomic_cmpxchg_bool(&lock->locked, 0, 1)) {
+            /*
+             * The releaser may have reserved this handoff between our two
+             * loads; its store to normal_turn precedes the release of
+             * locked, so the CAS's acquire makes it visible here.
+             */
+            if (atomic_load(&lock->normal_turn) == 0) {
+                break;
+            }
+            atomic_store_release(&lock->locked, 0);
+        }
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    atomic_dec(&lock->high_pending);
+    lock->holder_class = PRIO_HIGH;
+    mcs_unlock_node(&lock->queue[PRIO_HIGH], &node);
+}
+
+static inline void prio_lock_normal(prio_lock_t *lock)
+{
+    mcs_node_t node;
+
+    mcs_lock_node(&lock->queue[PRIO_NORMAL], &node);
+    atomic_store(&lock->normal_waiting, 1);
+
+    for (;;) {
+        if ((atomic_load(&lock->high_pending) == 0 || atomic_load(&lock->normal_turn) != 0) &&
+            atomic_load(&lock->locked) == 0 && atomic_cmpxchg_bool(&lock->locked, 0, 1)) {
+            break;
+        }
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    atomic_store(&lock->normal_waiting, 0);
+    atomic_store(&lock->normal_turn, 0);
+    lock->holder_class = PRIO_NORMAL;
+    lock->high_streak = 0;
+    mcs_unlock_node(&lock->queue[PRIO_NORMAL], &node);
+}
+
+static inline void prio_lock(prio_lock_t *lock, int high)
+{
+    if (high) {
+        prio_lock_high(lock);
+    } else {
+        prio_lock_normal(lock);
+    }
+}
+
+static inline void prio_unlock(prio_lock_t *lock)
+{
+    if (lock->holder_class == PRIO_HIGH && atomic_load(&lock->normal_waiting) != 0 &&
+        ++lock->high_streak >= PRIO_MAX_HIGH_STREAK) {
+        lock->high_streak = 0;
+        atomic_store(&lock->normal_turn, 1);
+    }
+    atomic_store_release(&lock->locked, 0);
+}
+
+#endif /* CAS_LOCK_PRIOLOCK_H */
@@ -0,0 +1,288 @@
+#ifndef CAS_LOCK_QSPINLOCK_H
+#define CAS_LOCK_QSPINLOCK_H
+
+#include "atomic.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+ * Queued Spinlock (after Linux qspinlock)
+ * A 4-byte lock, the same size as spinlock_t, that behaves like a TAS lock
+ * when uncontended, lets a single waiter spin on a pending bit in the lock
+ * word, and only queues further waiters MCS-style on their own nodes.
+ *
+ * Lock word layout:
+ *   bits  0- 7  locked byte
+ *   bits  8-15  pending byte (only bit 8 is used)
+ *   bits 16-17  tail node index within its thread's node array
+ *   bits 18-31  tail thread index + 1 (0 = no queue)
+ *
+ * Queue nodes are not passed in: each thread owns QSPIN_MAX_NODES padded
+ * nodes in TLS (one per nesting level, e.g. for signal handlers) and
+ * registers them in a global table on first contention, so the tail can
+ * be encoded in 16 bits.  A thread's slot is released when it exits.
+ * Nodes are only in use while waiting, so holding several qspinlocks at
+ * once needs no extra nodes.
+ */
+typedef union {
+    volatile uint32_t val;
+    struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        volatile uint8_t locked;
+        volatile uint8_t pending;
+        volatile uint16_t tail;
+#else
+        volatile uint16_t tail;
+        volatile uint8_t pending;
+        volatile uint8_t locked;
+#endif
+    };
+    struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        volatile uint16_t locked_pending;
+        volatile uint16_t tail_hi;
+#else
+        volatile uint16_t tail_hi;
+        volatile uint16_t locked_pending;
+#endif
+    };
+} qspinlock_t;
+
+#define QSPINLOCK_INITIALIZER {0}
+
+#define QSPIN_LOCKED_VAL        (1U << 0)
+#define QSPIN_PENDING_VAL       (1U << 8)
+#define QSPIN_LOCKED_MASK       0x000000ffU
+#define QSPIN_PENDING_MASK      0x0000ff00U
+#define QSPIN_LOCKED_PENDING_MASK (QSPIN_LOCKED_MASK | QSPIN_PENDING_MASK)
+#define QSPIN_TAIL_MASK         0xffff0000U
+#define QSPIN_TAIL_IDX_SHIFT    16
+#define QSPIN_TAIL_THREAD_SHIFT 18
+
+#define QSPIN_MAX_NODES   4
+#define QSPIN_MAX_THREADS ((1U << (32 - QSPIN_TAIL_THREAD_SHIFT)) - 1)
+
+/* Queue node, one cache line each */
+typedef struct qspin_node {
+    struct qspin_node *volatile next;
+    volatile uint32_t locked;       /* set to 1 when we reach the queue head */
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) qspin_node_t;
+
+typedef struct {
+    qspin_node_t nodes[QSPIN_MAX_NODES];
+    uint32_t count;                 /* nodes currently in use */
+    uint32_t thread;                /* registry index + 1, 0 if unregistered */
+} qspin_tls_t;
+
+/* Weak so every translation unit shares one table and one TLS block */
+__attribute__((weak)) __thread qspin_tls_t qspin_tls;
+__attribute__((weak)) qspin_node_t *volatile qspin_registry[QSPIN_MAX_THREADS];
+__attribute__((weak)) pthread_key_t qspin_exit_key;
+__attribute__((weak)) pthread_once_t qspin_exit_once = PTHREAD_ONCE_INIT;
+
+/* Thread exit: give the registry slot back */
+static inline void qspin_thread_exit(void *arg)
+{
+    uint32_t thread = (uint32_t)(uintptr_t)arg;
+    atomic_store_ptr_release((void *volatile *)&qspin_registry[thread - 1], NULL);
+}
+
+static inline void qspin_exit_key_create(void)
+{
+    if (pthread_key_create(&qspin_exit_key, qspin_thread_exit) != 0) {
+        abort();
+    }
+}
+
+/* Registry index + 1 of the calling thread, claiming a slot on first use */
+static inline uint32_t qspin_thread_id(qspin_tls_t *tls)
+{
+    uint32_t i;
+
+    if (tls->thread != 0) {
+        return tls->thread;
+    }
+
+    pthread_once(&qspin_exit_once, qspin_exit_key_create);
+    for (i = 0; i < QSPIN_MAX_THREADS; i++) {
+        if (atomic_load_ptr((void *volatile *)&qspin_registry[i]) == NULL &&
+            atomic_cmpxchg_ptr_bool((void *volatile *)&qspin_registry[i],
+                                    NULL, tls->nodes)) {
+            tls->thread = i + 1;
+            pthread_setspecific(qspin_exit_key, (void *)(uintptr_t)tls->thread);
+            return tls->thread;
+        }
+    }
+
+    /* More live threads than the tail can encode */
+    abort();
+}
+
+static inline uint32_t qspin_encode_tail(uint32_t thread, uint32_t idx)
+{
+    return (thread << QSPIN_TAIL_THREAD_SHIFT) | (idx << QSPIN_TAIL_IDX_SHIFT);
+}
+
+static inline qspin_node_t *qspin_decode_tail(uint32_t tail)
+{
+    uint32_t thread = tail >> QSPIN_TAIL_THREAD_SHIFT;
+    uint32_t idx = (tail & ~(~0U << QSPIN_TAIL_THREAD_SHIFT)) >> QSPIN_TAIL_IDX_SHIFT;
+    qspin_node_t *nodes;
+
+    nodes = (qspin_node_t *)atomic_load_ptr_acquire(
+        (void *volatile *)&qspin_registry[thread - 1]);
+    return &nodes[idx];
+}
+
+static inline void qspin_init(qspinlock_t *lock)
+{
+    atomic_store(&lock->val, 0);
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int qspin_trylock(qspinlock_t *lock)
+{
+    uint32_t val = atomic_load(&lock->val);
+
+    if (val != 0) {
+        return 0;
+    }
+    return atomic_cmpxchg_bool(&lock->val, 0, QSPIN_LOCKED_VAL);
+}
+
+/* Contended path: pending bit for the first waiter, MCS queue beyond */
+static inline void qspin_lock_slowpath(qspinlock_t *lock, uint32_t val)
+{
+    qspin_tls_t *tls;
+    qspin_node_t *node, *prev, *next;
+    uint32_t idx, tail, old;
+
+    /* Owner is handing over to the pending waiter; give it one poll */
+    if (val == QSPIN_PENDING_VAL) {
+        cpu_pause();
+        val = atomic_load(&lock->val);
+    }
+
+    /* Anyone already pending or queued: get in line */
+    if (val & ~QSPIN_LOCKED_MASK) {
+        goto queue;
+    }
+
+    /* Become the pending waiter */
+    val = atomic_or(&lock->val, QSPIN_PENDING_VAL);
+    if (val & ~QSPIN_LOCKED_MASK) {
+        /* Lost the race; undo the pending bit only if we were the one to set it */
+        if (!(val & QSPIN_PENDING_MASK)) {
+            __atomic_store_n(&lock->pending, (uint8_t)0, __ATOMIC_RELAXED);
+        }
+        goto queue;
+    }
+
+    /* Wait for the owner, then take the lock and drop pending in one store */
+    while (__atomic_load_n(&lock->locked, __ATOMIC_ACQUIRE) != 0) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+    __atomic_store_n(&lock->locked_pending, (uint16_t)QSPIN_LOCKED_VAL, __ATOMIC_RELAXED);
+    return;
+
+queue:
+    tls = &qspin_tls;
+    idx = tls->count;
+
+    /* Out of nodes (deep signal nesting): spin on trylock instead */
+    if (idx >= QSPIN_MAX_NODES) {
+        while (!qspin_trylock(lock)) {
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+        return;
+    }
+
+    tail = qspin_encode_tail(qspin_thread_id(tls), idx);
+    tls->count = idx + 1;
+    node = &tls->nodes[idx];
+    node->locked = 0;
+    node->next = NULL;
+
+    /* The lock may have been released while we were setting up */
+    if (qspin_trylock(lock)) {
+        goto release;
+    }
+
+    /* Publish our node; acq_rel orders the node init before it is found */
+    old = (uint32_t)__atomic_exchange_n(&lock->tail_hi,
+                                        (uint16_t)(tail >> 16),
+                                        __ATOMIC_ACQ_REL) << 16;
+    next = NULL;
+
+    if (old & QSPIN_TAIL_MASK) {
+        prev = qspin_decode_tail(old);
+        atomic_store_ptr_release((void *volatile *)&prev->next, node);
+
+        while (atomic_load_acquire(&node->locked) == 0) {
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+
+        /* Prefetch the successor while the lock word is still busy */
+        next = (qspin_node_t *)atomic_load_ptr((void *volatile *)&node->next);
+    }
+
+    /* Queue head: wait for the owner and any pending waiter to leave */
+    while ((val = atomic_load_acquire(&lock->val)) & QSPIN_LOCKED_PENDING_MASK) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    /* Last in the queue: clear the tail while taking the lock */
+    if ((val & QSPIN_TAIL_MASK) == tail &&
+        atomic_cmpxchg_bool(&lock->val, val, QSPIN_LOCKED_VAL)) {
+        goto release;
+    }
+
+    /* Others queued behind us; nobody else can set the locked byte now */
+    __atomic_store_n(&lock->locked, (uint8_t)QSPIN_LOCKED_VAL, __ATOMIC_RELAXED);
+
+    while (next == NULL) {
+        next = (qspin_node_t *)atomic_load_ptr_acquire((void *volatile *)&node->next);
+        cpu_pause();
+    }
+    atomic_store_release(&next->locked, 1);
+
+release:
+    tls->count--;
+}
+
+/* Acquire lock */
+static inline void qspin_lock(qspinlock_t *lock)
+{
+    uint32_t val = 0;
+
+    /* Uncontended: a single CAS, no queue node touched */
+    if (__atomic_compare_exchange_n(&lock->val, &val, QSPIN_LOCKED_VAL, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    qspin_lock_slowpath(lock, val);
+}
+
+/* Release lock */
+static inline void qspin_unlock(qspinlock_t *lock)
+{
+    __atomic_store_n(&lock->locked, (uint8_t)0, __ATOMIC_RELEASE);
+}
+
+/* Returns 1 if the lock is held */
+static inline int qspin_is_locked(qspinlock_t *lock)
+{
+    return atomic_load(&lock->val) != 0;
+}
+
+/* Returns 1 if at least one thread is pending or queued */
+static inline int qspin_is_contended(qspinlock_t *lock)
+{
+    return (atomic_load(&lock->val) & ~QSPIN_LOCKED_MASK) != 0;
+}
+
+#endif /* CAS_LOCK_QSPINLOCK_H */
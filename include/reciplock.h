@@ -0,0 +1,106 @@
+#ifndef CAS_LOCK_RECIPLOCK_H
+#define CAS_LOCK_RECIPLOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+
+/*
+ * Reciprocating Lock (Dice and Kogan)
+ * A one-word lock whose waiters push a wait element from their own stack
+ * onto an arrival stack.  When the holder finds no successor in its
+ * segment, it detaches the whole arrival stack as the next segment and
+ * grants its top; each waiter then grants the one that arrived before it.
+ * Admission alternates between segments, so a waiter is bypassed by at
+ * most one segment of later arrivals.  Every waiter spins on its own
+ * element and a handoff is a single store to it.
+ *
+ * The grant carries the segment's end marker: the address of the element
+ * below the segment, which is only compared, never dereferenced, so wait
+ * elements need not outlive recip_lock().  What the holder needs for
+ * release is returned as a recip_ctx_t and passed back to recip_unlock().
+ *
+ * Lock word: NULL when free, RECIP_LOCKED_EMPTY when held with no
+ * arrivals, else the most recent arrival.
+ */
+#define RECIP_LOCKED_EMPTY ((recip_elem_t *)(uintptr_t)1)
+
+typedef struct recip_elem {
+    struct recip_elem *volatile gate;   /* NULL until granted, then end marker */
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) recip_elem_t;
+
+typedef struct {
+    recip_elem_t *volatile arrivals;
+} recip_lock_t;
+
+/* Held by the owner between lock and unlock */
+typedef struct {
+    recip_elem_t *succ;             /* next to admit in this segment, or NULL */
+    recip_elem_t *eos;              /* end-of-segment marker to pass on */
+} recip_ctx_t;
+
+#define RECIP_LOCK_INITIALIZER {NULL}
+
+static inline void recip_init(recip_lock_t *lock)
+{
+    atomic_store_ptr((void *volatile *)&lock->arrivals, NULL);
+}
+
+static inline recip_ctx_t recip_lock(recip_lock_t *lock)
+{
+    recip_elem_t elem;
+    recip_ctx_t ctx;
+    recip_elem_t *tail;
+
+    elem.gate = NULL;
+    ctx.succ = NULL;
+    ctx.eos = &elem;
+
+    tail = (recip_elem_t *)atomic_xchg_ptr((void *volatile *)&lock->arrivals, &elem);
+    if (tail == NULL) {
+        return ctx;
+    }
+
+    ctx.succ = tail != RECIP_LOCKED_EMPTY ? tail : NULL;
+    while ((ctx.eos = (recip_elem_t *)atomic_load_ptr_acquire((void *volatile *)&elem.gate)) == NULL) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    /* Our predecessor on the stack is the segment's end: we are last */
+    if (ctx.succ == ctx.eos) {
+        ctx.succ = NULL;
+        ctx.eos = RECIP_LOCKED_EMPTY;
+    }
+    return ctx;
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int recip_trylock(recip_lock_t *lock, recip_ctx_t *ctx)
+{
+    if (atomic_load_ptr((void *volatile *)&lock->arrivals) != NULL ||
+        !atomic_cmpxchg_ptr_bool((void *volatile *)&lock->arrivals, NULL, RECIP_LOCKED_EMPTY)) {
+        return 0;
+    }
+    ctx->succ = NULL;
+    ctx->eos = RECIP_LOCKED_EMPTY;
+    return 1;
+}
+
+static inline void recip_unlock(recip_lock_t *lock, recip_ctx_t ctx)
+{
+    recip_elem_t *top;
+
+    if (ctx.succ != NULL) {
+        atomic_store_ptr_release((void *volatile *)&ctx.succ->gate, ctx.eos);
+        return;
+    }
+
+    /* End of segment: free the lock, or detach the arrivals as the next */
+    if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->arrivals, ctx.eos, NULL)) {
+        return;
+    }
+    top = (recip_elem_t *)atomic_xchg_ptr((void *volatile *)&lock->arrivals, RECIP_LOCKED_EMPTY);
+    atomic_store_ptr_release((void *volatile *)&top->gate, ctx.eos);
+}
+
+#endif /* CAS_LOCK_RECIPLOCK_H */
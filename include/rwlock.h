@@ -2,45 +2,53 @@
 #define CAS_LOCK_RWLOCK_H
 
 #include "atomic.h"
+#include "platform.h"
 
 /*
  * Simple Reader-Writer Lock
  * Multiple readers can hold the lock simultaneously
  * Writers have exclusive access
  * Writer-preferring implementation
+ *
+ * Everything lives in one 32-bit word, so every acquire and release is a
+ * single atomic read-modify-write on one cache line:
+ *   bit 31     - a writer holds the lock
+ *   bit 30     - a writer is waiting; new readers stay out
+ *   bits 0-29  - number of readers holding the lock
+ * A writer clears the waiting bit when it gets the lock; other writers
+ * still waiting set it again while they spin.
  */
+#define RW_WRITER         0x80000000U
+#define RW_WRITER_WAITING 0x40000000U
+#define RW_READER_MASK    0x3fffffffU
+
 typedef struct {
-    volatile uint32_t readers;
-    volatile uint32_t writer;
+    volatile uint32_t word;
 } rwlock_t;
 
-#define RWLOCK_INITIALIZER {0, 0}
+#define RWLOCK_INITIALIZER {0}
 
 /* Initialize rwlock */
 static inline void rw_init(rwlock_t *lock)
 {
-    atomic_store(&lock->readers, 0);
-    atomic_store(&lock->writer, 0);
+    atomic_store(&lock->word, 0);
 }
 
 /* Acquire read lock */
 static inline void rw_read_lock(rwlock_t *lock)
 {
-    /* Wait while there's an active or waiting writer */
+    uint32_t v;
+
     while (1) {
-        /* Check if no writer */
-        if (atomic_load(&lock->writer) == 0) {
-            /* Try to increment reader count */
-            uint32_t old_readers = atomic_load(&lock->readers);
-            if (atomic_cmpxchg_bool(&lock->readers, old_readers, old_readers + 1)) {
-                /* Verify no writer acquired while we were incrementing */
-                if (atomic_load(&lock->writer) == 0) {
-                    return;
-                }
-                /* Writer acquired, back off */
-                atomic_dec(&lock->readers);
+        v = atomic_load(&lock->word);
+        /* No writer holding or waiting: add ourselves */
+        if ((v & (RW_WRITER | RW_WRITER_WAITING)) == 0) {
+            if (atomic_cmpxchg_bool(&lock->word, v, v + 1)) {
+                return;
             }
+            continue;
         }
+        CAS_LOCK_POLL_HOOK();
         cpu_pause();
     }
 }
@@ -48,15 +56,14 @@ static inline void rw_read_lock(rwlock_t *lock)
 /* Try to acquire read lock - returns 1 on success */
 static inline int rw_read_trylock(rwlock_t *lock)
 {
-    if (atomic_load(&lock->writer) != 0) {
-        return 0;
-    }
-    uint32_t old_readers = atomic_load(&lock->readers);
-    if (atomic_cmpxchg_bool(&lock->readers, old_readers, old_readers + 1)) {
-        if (atomic_load(&lock->writer) == 0) {
+    uint32_t v = atomic_load(&lock->word);
+
+    /* Retry only while other readers move the count */
+    while ((v & (RW_WRITER | RW_WRITER_WAITING)) == 0) {
+        if (atomic_cmpxchg_bool(&lock->word, v, v + 1)) {
             return 1;
         }
-        atomic_dec(&lock->readers);
+        v = atomic_load(&lock->word);
     }
     return 0;
 }
@@ -64,19 +71,28 @@ static inline int rw_read_trylock(rwlock_t *lock)
 /* Release read lock */
 static inline void rw_read_unlock(rwlock_t *lock)
 {
-    atomic_dec(&lock->readers);
+    atomic_dec(&lock->word);
 }
 
 /* Acquire write lock */
 static inline void rw_write_lock(rwlock_t *lock)
 {
-    /* Announce we want to write */
-    while (atomic_xchg(&lock->writer, 1) != 0) {
-        cpu_pause();
-    }
+    uint32_t v;
 
-    /* Wait for all readers to finish */
-    while (atomic_load(&lock->readers) != 0) {
+    while (1) {
+        v = atomic_load(&lock->word);
+        /* No readers, no writer: take it, consuming the waiting bit */
+        if ((v & ~RW_WRITER_WAITING) == 0) {
+            if (atomic_cmpxchg_bool(&lock->word, v, RW_WRITER)) {
+                return;
+            }
+            continue;
+        }
+        /* Announce we want to write so new readers hold off */
+        if ((v & RW_WRITER_WAITING) == 0) {
+            atomic_cmpxchg_bool(&lock->word, v, v | RW_WRITER_WAITING);
+        }
+        CAS_LOCK_POLL_HOOK();
         cpu_pause();
     }
 }
@@ -84,20 +100,20 @@ static inline void rw_write_lock(rwlock_t *lock)
 /* Try to acquire write lock - returns 1 on success */
 static inline int rw_write_trylock(rwlock_t *lock)
 {
-    if (atomic_xchg(&lock->writer, 1) != 0) {
-        return 0;
-    }
-    if (atomic_load(&lock->readers) != 0) {
-        atomic_store(&lock->writer, 0);
+    uint32_t v = atomic_load(&lock->word);
+
+    /* Never touches the word while someone holds the lock */
+    if ((v & ~RW_WRITER_WAITING) != 0) {
         return 0;
     }
-    return 1;
+    return atomic_cmpxchg_bool(&lock->word, v, RW_WRITER);
 }
 
 /* Release write lock */
 static inline void rw_write_unlock(rwlock_t *lock)
 {
-    atomic_store_release(&lock->writer, 0);
+    /* Keep the waiting bit another writer may have set meanwhile */
+    atomic_and(&lock->word, ~RW_WRITER);
 }
 
 /*
@@ -170,4 +186,228 @@ static inline void rw_phase_write_unlock(rwlock_phase_t *lock)
     atomic_store(&lock->read_phase, 1);
 }
 
+/*
+ * Ticket Reader-Writer Lock
+ * Readers and writers draw tickets from one counter, so both classes are
+ * served strictly in arrival order and neither can starve the other.
+ * Three 16-bit fields share a 64-bit word:
+ *   users - next ticket to hand out
+ *   read  - readers holding a ticket below this may enter
+ *   write - a writer holding this ticket may enter
+ * An admitted reader bumps read at once, so a run of consecutive readers
+ * enters as a batch; each reader bumps write on exit, so the next writer
+ * waits for every earlier ticket.  Up to 65535 threads may queue at once.
+ */
+typedef union {
+    volatile uint64_t word;
+    struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        volatile uint16_t write;
+        volatile uint16_t read;
+        volatile uint16_t users;
+        volatile uint16_t pad;
+#else
+        volatile uint16_t pad;
+        volatile uint16_t users;
+        volatile uint16_t read;
+        volatile uint16_t write;
+#endif
+    };
+    struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        volatile uint32_t write_read;   /* write and read, stored together */
+        volatile uint32_t hi;
+#else
+        volatile uint32_t hi;
+        volatile uint32_t write_read;
+#endif
+    };
+} rwlock_ticket_t;
+
+#define RWLOCK_TICKET_INITIALIZER {0}
+
+#define RW_TICKET_READ_SHIFT  16
+#define RW_TICKET_USERS_SHIFT 32
+#define RW_TICKET_USERS_INC   (1ULL << RW_TICKET_USERS_SHIFT)
+
+#define RW_TICKET_WRITE(word) ((uint16_t)(word))
+#define RW_TICKET_READ(word)  ((uint16_t)((word) >> RW_TICKET_READ_SHIFT))
+#define RW_TICKET_USERS(word) ((uint16_t)((word) >> RW_TICKET_USERS_SHIFT))
+
+static inline void rw_ticket_init(rwlock_ticket_t *lock)
+{
+    atomic_store64(&lock->word, 0);
+}
+
+static inline void rw_ticket_read_lock(rwlock_ticket_t *lock)
+{
+    uint16_t my_ticket = RW_TICKET_USERS(atomic_fetch_add64(&lock->word, RW_TICKET_USERS_INC));
+
+    while (__atomic_load_n(&lock->read, __ATOMIC_ACQUIRE) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    /* Admit the next ticket too if it belongs to a reader */
+    __atomic_store_n(&lock->read, (uint16_t)(my_ticket + 1), __ATOMIC_RELEASE);
+}
+
+/* Try to acquire read lock - returns 1 on success */
+static inline int rw_ticket_read_trylock(rwlock_ticket_t *lock)
+{
+    uint64_t old = atomic_load64(&lock->word);
+    uint16_t users = RW_TICKET_USERS(old);
+    uint64_t new_word;
+
+    /* Readers are admitted only if nobody is queued ahead */
+    if (RW_TICKET_READ(old) != users) {
+        return 0;
+    }
+
+    new_word = (old & 0xFFFFULL) |
+               ((uint64_t)(uint16_t)(users + 1) << RW_TICKET_READ_SHIFT) |
+               ((uint64_t)(uint16_t)(users + 1) << RW_TICKET_USERS_SHIFT);
+    return atomic_cmpxchg64_bool(&lock->word, old, new_word);
+}
+
+static inline void rw_ticket_read_unlock(rwlock_ticket_t *lock)
+{
+    __atomic_fetch_add(&lock->write, (uint16_t)1, __ATOMIC_RELEASE);
+}
+
+static inline void rw_ticket_write_lock(rwlock_ticket_t *lock)
+{
+    uint16_t my_ticket = RW_TICKET_USERS(atomic_fetch_add64(&lock->word, RW_TICKET_USERS_INC));
+
+    while (__atomic_load_n(&lock->write, __ATOMIC_ACQUIRE) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+}
+
+/* Try to acquire write lock - returns 1 on success */
+static inline int rw_ticket_write_trylock(rwlock_ticket_t *lock)
+{
+    uint64_t old = atomic_load64(&lock->word);
+
+    /* Every earlier ticket has left */
+    if (RW_TICKET_WRITE(old) != RW_TICKET_USERS(old)) {
+        return 0;
+    }
+    return atomic_cmpxchg64_bool(&lock->word, old, old + RW_TICKET_USERS_INC);
+}
+
+static inline void rw_ticket_write_unlock(rwlock_ticket_t *lock)
+{
+    /* Only the writer can move either field now: pass both on in one store */
+    uint32_t old = atomic_load(&lock->write_read);
+    uint32_t next = (uint32_t)(uint16_t)(old + 1) |
+                    ((uint32_t)(uint16_t)((old >> RW_TICKET_READ_SHIFT) + 1) << RW_TICKET_READ_SHIFT);
+    atomic_store_release(&lock->write_read, next);
+}
+
+/*
+ * Big-Reader Lock (brlock)
+ * For data read constantly and written rarely.  An array of per-CPU
+ * slots, each a writer-preferring rwlock_t on its own cache line: a
+ * reader locks only the slot of the CPU it runs on, so readers on
+ * different CPUs never share a line, while a writer takes every slot in
+ * order, which makes writes cost O(slots).
+ *
+ * A thread may migrate while reading, so rw_br_read_lock() returns the
+ * slot it took, to be passed back to rw_br_read_unlock().  The slot array
+ * is allocated by rw_br_init(); there is no static initializer.
+ */
+typedef struct {
+    rwlock_t lock;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) rwlock_br_slot_t;
+
+typedef struct {
+    rwlock_br_slot_t *slots;
+    uint32_t mask;                  /* slot count - 1, a power of two */
+} rwlock_br_t;
+
+/* num_slots of 0 uses one slot per CPU - returns 0 on success, -1 on allocation failure */
+static inline int rw_br_init(rwlock_br_t *lock, uint32_t num_slots)
+{
+    uint32_t n = cas_pow2_roundup(num_slots ? num_slots : cas_num_cpus());
+    uint32_t i;
+
+    lock->slots = (rwlock_br_slot_t *)cas_default_alloc(n * sizeof(rwlock_br_slot_t),
+                                                        CAS_LOCK_CACHELINE);
+    if (lock->slots == NULL) {
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        rw_init(&lock->slots[i].lock);
+    }
+    lock->mask = n - 1;
+    return 0;
+}
+
+/* Release the slot array; the lock must be free and unused */
+static inline void rw_br_destroy(rwlock_br_t *lock)
+{
+    cas_default_free(lock->slots);
+    lock->slots = NULL;
+}
+
+/* Acquire read lock on the caller's CPU slot - returns the slot */
+static inline uint32_t rw_br_read_lock(rwlock_br_t *lock)
+{
+    uint32_t slot = cas_current_cpu() & lock->mask;
+
+    rw_read_lock(&lock->slots[slot].lock);
+    return slot;
+}
+
+/* Try to acquire read lock - returns 1 on success and stores the slot */
+static inline int rw_br_read_trylock(rwlock_br_t *lock, uint32_t *slot)
+{
+    *slot = cas_current_cpu() & lock->mask;
+    return rw_read_trylock(&lock->slots[*slot].lock);
+}
+
+/* Release read lock taken on `slot` */
+static inline void rw_br_read_unlock(rwlock_br_t *lock, uint32_t slot)
+{
+    rw_read_unlock(&lock->slots[slot].lock);
+}
+
+/* Acquire write lock: every slot, in index order so writers cannot deadlock */
+static inline void rw_br_write_lock(rwlock_br_t *lock)
+{
+    uint32_t i;
+
+    for (i = 0; i <= lock->mask; i++) {
+        rw_write_lock(&lock->slots[i].lock);
+    }
+}
+
+/* Try to acquire write lock - returns 1 on success */
+static inline int rw_br_write_trylock(rwlock_br_t *lock)
+{
+    uint32_t i;
+
+    for (i = 0; i <= lock->mask; i++) {
+        if (!rw_write_trylock(&lock->slots[i].lock)) {
+            while (i-- > 0) {
+                rw_write_unlock(&lock->slots[i].lock);
+            }
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Release write lock */
+static inline void rw_br_write_unlock(rwlock_br_t *lock)
+{
+    uint32_t i;
+
+    for (i = 0; i <= lock->mask; i++) {
+        rw_write_unlock(&lock->slots[i].lock);
+    }
+}
+
 #endif /* CAS_LOCK_RWLOCK_H */
@@ -0,0 +1,94 @@
+#ifndef CAS_LOCK_SCLLOCK_H
+#define CAS_LOCK_SCLLOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+#include "ticketlock.h"
+
+/*
+ * Scheduler-Cooperative Lock (Patel et al., u-SCL)
+ * Fair shares of lock opportunity rather than of acquisitions: a thread
+ * whose critical sections are long gets the lock as often as the others
+ * but is then kept away long enough that its share of hold time matches
+ * its weight.  Users register an scl_class_t per thread, or one per class
+ * of threads, with a weight.  On release the holder's hold time t is
+ * charged to its class, which is banned for
+ *
+ *     t * (total_weight - weight) / weight
+ *
+ * i.e. the time the other registered classes are owed.  A banned class
+ * waits before it queues, sleeping if the ban is long, so it never holds
+ * up the ticket queue.  Like u-SCL this is not work-conserving: the lock
+ * may sit idle while the only thread that wants it is banned, so register
+ * a class only while its threads use the lock.
+ */
+#ifndef SCL_SLEEP_MIN_NS
+#define SCL_SLEEP_MIN_NS 50000      /* shorter bans are waited out spinning */
+#endif
+
+typedef struct {
+    uint32_t weight;
+    volatile uint64_t banned_until;     /* cas_clock_ns() time */
+    volatile uint64_t hold_ns;          /* total time held, for reporting */
+} scl_class_t;
+
+typedef struct {
+    ticketlock_t lock;
+    volatile uint32_t total_weight;     /* of registered classes */
+    uint64_t acquired_at;               /* written by the holder */
+} scl_lock_t;
+
+#define SCL_LOCK_INITIALIZER {TICKETLOCK_INITIALIZER, 0, 0}
+
+static inline void scl_init(scl_lock_t *lock)
+{
+    ticket_init(&lock->lock);
+    atomic_store(&lock->total_weight, 0);
+    lock->acquired_at = 0;
+}
+
+/* weight 0 counts as 1 */
+static inline void scl_register(scl_lock_t *lock, scl_class_t *cls, uint32_t weight)
+{
+    cls->weight = weight != 0 ? weight : 1;
+    atomic_store64(&cls->banned_until, 0);
+    atomic_store64(&cls->hold_ns, 0);
+    atomic_fetch_add(&lock->total_weight, cls->weight);
+}
+
+static inline void scl_unregister(scl_lock_t *lock, scl_class_t *cls)
+{
+    atomic_sub(&lock->total_weight, cls->weight);
+}
+
+static inline void scl_lock(scl_lock_t *lock, scl_class_t *cls)
+{
+    uint64_t now, until;
+
+    while ((until = atomic_load64(&cls->banned_until)) > (now = cas_clock_ns())) {
+        if (until - now >= SCL_SLEEP_MIN_NS) {
+            cas_sleep_ns(until - now);
+        } else {
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+    }
+
+    ticket_lock(&lock->lock);
+    lock->acquired_at = cas_clock_ns();
+}
+
+static inline void scl_unlock(scl_lock_t *lock, scl_class_t *cls)
+{
+    uint64_t now = cas_clock_ns();
+    uint64_t held = now - lock->acquired_at;
+    uint32_t total = atomic_load(&lock->total_weight);
+
+    atomic_store64(&cls->hold_ns, cls->hold_ns + held);
+    if (total > cls->weight) {
+        atomic_store64(&cls->banned_until, now + held * (total - cls->weight) / cls->weight);
+    }
+    ticket_unlock(&lock->lock);
+}
+
+#endif /* CAS_LOCK_SCLLOCK_H */
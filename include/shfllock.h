@@ -0,0 +1,215 @@
+#ifndef CAS_LOCK_SHFLLOCK_H
+#define CAS_LOCK_SHFLLOCK_H
+
+#include "atomic.h"
+#include "platform.h"
+
+/*
+ * Shuffle Lock (Kashyap et al., ShflLock)
+ * A test-and-set lock word for the fast path plus an MCS-style queue of
+ * waiters.  The waiter at the head of the queue, while it waits for the
+ * holder anyway, walks the queue and pulls waiters the lock's policy
+ * selects up behind itself, so reordering costs nothing on the critical
+ * path.  Once the queue is non-empty the head blocks lock stealing so
+ * queued waiters cannot be starved by the fast path.
+ *
+ * Every waiter carries a key, by default its NUMA node, or whatever
+ * shfl_set_thread_key() set (e.g. a thread class).  The policy decides
+ * from the head's and a waiter's node whether the waiter moves forward.
+ * A waiter that has been moved SHFL_MAX_BATCH times in a row does not
+ * shuffle when it reaches the head, which bounds how long others can be
+ * passed over.  Queue nodes live on the waiter's stack during acquisition
+ * only; unlock needs no node.
+ */
+#ifndef SHFL_MAX_BATCH
+#define SHFL_MAX_BATCH 256
+#endif
+
+#define SHFL_WAITING 0
+#define SHFL_HEAD    1
+
+/* Lock word: locked byte in bits 0-7, no_steal byte in bits 8-15 */
+#define SHFL_LOCKED_VAL  1U
+#define SHFL_LOCKED_MASK 0xffU
+
+typedef struct shfl_node {
+    struct shfl_node *volatile next;
+    volatile uint32_t status;
+    uint32_t key;
+    uint32_t batch;                 /* times moved forward in a row */
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) shfl_node_t;
+
+/* Returns nonzero if `waiter` should be moved up behind `head` */
+typedef int (*shfl_policy_fn)(const shfl_node_t *head, const shfl_node_t *waiter);
+
+typedef struct {
+    union {
+        volatile uint32_t val;
+        struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            volatile uint8_t locked;
+            volatile uint8_t no_steal;
+            volatile uint16_t pad;
+#else
+            volatile uint16_t pad;
+            volatile uint8_t no_steal;
+            volatile uint8_t locked;
+#endif
+        };
+    };
+    shfl_node_t *volatile tail;
+    shfl_policy_fn policy;
+} shfl_lock_t;
+
+/* Group waiters with the head's key: NUMA node or thread class */
+static inline int shfl_policy_same_key(const shfl_node_t *head, const shfl_node_t *waiter)
+{
+    return waiter->key == head->key;
+}
+
+/* Let waiters with a higher key (priority) than the head overtake */
+static inline int shfl_policy_priority(const shfl_node_t *head, const shfl_node_t *waiter)
+{
+    return waiter->key > head->key;
+}
+
+#define SHFL_LOCK_INITIALIZER {{0}, NULL, shfl_policy_same_key}
+
+/* Cached key of this thread, SHFL_KEY_UNKNOWN until first use */
+#define SHFL_KEY_UNKNOWN UINT32_MAX
+
+__attribute__((weak)) __thread uint32_t shfl_thread_key = SHFL_KEY_UNKNOWN;
+
+/* Override the calling thread's key (default: its NUMA node) */
+static inline void shfl_set_thread_key(uint32_t key)
+{
+    shfl_thread_key = key;
+}
+
+/* policy NULL selects shfl_policy_same_key */
+static inline void shfl_init(shfl_lock_t *lock, shfl_policy_fn policy)
+{
+    lock->policy = policy != NULL ? policy : shfl_policy_same_key;
+    atomic_store_ptr((void *volatile *)&lock->tail, NULL);
+    atomic_store(&lock->val, 0);
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int shfl_trylock(shfl_lock_t *lock)
+{
+    return atomic_load(&lock->val) == 0 &&
+           atomic_cmpxchg_bool(&lock->val, 0, SHFL_LOCKED_VAL);
+}
+
+/*
+ * Pull waiters matching the policy up behind `head`.  Only nodes with a
+ * successor are moved or relinked: the tail's next may be written by an
+ * arriving thread at any time.
+ */
+static inline void shfl_shuffle(shfl_lock_t *lock, shfl_node_t *head)
+{
+    shfl_node_t *last = head, *prev = head;
+    shfl_node_t *curr, *next;
+    uint32_t batch = head->batch;
+
+    if (batch >= SHFL_MAX_BATCH) {
+        return;
+    }
+
+    for (;;) {
+        curr = (shfl_node_t *)atomic_load_ptr_acquire((void *volatile *)&prev->next);
+        if (curr == NULL) {
+            break;
+        }
+        next = (shfl_node_t *)atomic_load_ptr_acquire((void *volatile *)&curr->next);
+        if (next == NULL) {
+            break;
+        }
+
+        if (lock->policy(head, curr)) {
+            curr->batch = batch + 1;
+            if (prev != last) {
+                /* Unlink curr and reinsert it after the last moved waiter */
+                prev->next = next;
+                curr->next = last->next;
+                last->next = curr;
+            } else {
+                prev = curr;
+            }
+            last = curr;
+        } else {
+            curr->batch = 0;
+            prev = curr;
+        }
+    }
+}
+
+static inline void shfl_lock(shfl_lock_t *lock)
+{
+    shfl_node_t node;
+    shfl_node_t *prev, *next;
+    uint32_t val;
+
+    /* Fast path: free and nobody queued */
+    if (shfl_trylock(lock)) {
+        return;
+    }
+
+    if (shfl_thread_key == SHFL_KEY_UNKNOWN) {
+        shfl_thread_key = cas_numa_node();
+    }
+    node.next = NULL;
+    node.status = SHFL_WAITING;
+    node.key = shfl_thread_key;
+    node.batch = 0;
+
+    prev = (shfl_node_t *)atomic_xchg_ptr((void *volatile *)&lock->tail, &node);
+    if (prev != NULL) {
+        atomic_store_ptr_release((void *volatile *)&prev->next, &node);
+        while (atomic_load_acquire(&node.status) == SHFL_WAITING) {
+            CAS_LOCK_POLL_HOOK();
+            cpu_pause();
+        }
+    }
+
+    /* Queue head: keep newcomers off the fast path, then reorder */
+    __atomic_store_n(&lock->no_steal, (uint8_t)1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED) != 0) {
+        shfl_shuffle(lock, &node);
+    }
+
+    for (;;) {
+        val = atomic_load(&lock->val);
+        if ((val & SHFL_LOCKED_MASK) == 0 &&
+            atomic_cmpxchg_bool(&lock->val, val, val | SHFL_LOCKED_VAL)) {
+            break;
+        }
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+
+    /*
+     * Hand the head role on.  Stealing is re-enabled before the tail is
+     * cleared, so a newcomer that becomes head right after cannot have
+     * its no_steal overwritten; a successor already queued sets it again.
+     */
+    next = (shfl_node_t *)atomic_load_ptr_acquire((void *volatile *)&node.next);
+    if (next == NULL) {
+        __atomic_store_n(&lock->no_steal, (uint8_t)0, __ATOMIC_RELAXED);
+        if (atomic_cmpxchg_ptr_bool((void *volatile *)&lock->tail, &node, NULL)) {
+            return;
+        }
+        while ((next = (shfl_node_t *)atomic_load_ptr_acquire((void *volatile *)&node.next)) == NULL) {
+            cpu_pause();
+        }
+    }
+    atomic_store_release(&next->status, SHFL_HEAD);
+}
+
+/* Release lock */
+static inline void shfl_unlock(shfl_lock_t *lock)
+{
+    __atomic_store_n(&lock->locked, (uint8_t)0, __ATOMIC_RELEASE);
+}
+
+#endif /* CAS_LOCK_SHFLLOCK_H */
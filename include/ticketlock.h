@@ -1,7 +1,11 @@
 #ifndef CAS_LOCK_TICKETLOCK_H
 #define CAS_LOCK_TICKETLOCK_H
 
+#include <string.h>
+
 #include "atomic.h"
+#include "platform.h"
+#include "lockstat.h"
 
 /*
  * Ticket Lock - Fair spinlock
@@ -30,6 +34,7 @@ static inline void ticket_lock(ticketlock_t *lock)
 
     /* Wait until my ticket is served */
     while (atomic_load_acquire(&lock->serving) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
         cpu_pause();
     }
 }
@@ -61,60 +66,692 @@ static inline void ticket_unlock(ticketlock_t *lock)
     atomic_store_release(&lock->serving, next);
 }
 
+/* Threads holding or waiting for the lock, i.e. ahead of a newcomer */
+static inline uint32_t ticket_queue_length(ticketlock_t *lock)
+{
+    return atomic_load(&lock->next_ticket) - atomic_load(&lock->serving);
+}
+
+/*
+ * Ticket Lock with hold-time statistics
+ * Opt-in variant for callers that want ticket_estimated_wait_ns(): the
+ * plain ticketlock_t plus a lock_stat_t, so only users of the estimate
+ * pay for the sampling.  The holder's ticket is the serving count.
+ */
+typedef struct {
+    ticketlock_t lock;
+    lock_stat_t stat;
+} ticket_stat_lock_t;
+
+#define TICKET_STAT_LOCK_INITIALIZER {TICKETLOCK_INITIALIZER, LOCK_STAT_INITIALIZER}
+
+static inline void ticket_stat_init(ticket_stat_lock_t *lock)
+{
+    ticket_init(&lock->lock);
+    lock_stat_init(&lock->stat);
+}
+
+static inline void ticket_stat_lock(ticket_stat_lock_t *lock)
+{
+    ticket_lock(&lock->lock);
+    lock_stat_acquired(&lock->stat, lock->lock.serving);
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int ticket_stat_trylock(ticket_stat_lock_t *lock)
+{
+    if (!ticket_trylock(&lock->lock)) {
+        return 0;
+    }
+    lock_stat_acquired(&lock->stat, lock->lock.serving);
+    return 1;
+}
+
+static inline void ticket_stat_unlock(ticket_stat_lock_t *lock)
+{
+    lock_stat_releasing(&lock->stat);
+    ticket_unlock(&lock->lock);
+}
+
+/* Estimated wait for a newcomer, 0 until a hold time has been sampled */
+static inline uint64_t ticket_estimated_wait_ns(ticket_stat_lock_t *lock)
+{
+    return lock_stat_estimate_ns(&lock->stat, ticket_queue_length(&lock->lock));
+}
+
+/*
+ * Proportional-backoff Ticket Lock
+ * A waiter that is N places from the head sleeps for roughly N-1 handoffs
+ * before looking at serving again, and only polls tightly once it is next,
+ * so an unlock invalidates the line in a few waiters instead of all of them.
+ */
+typedef struct {
+    volatile uint32_t next_ticket;
+    volatile uint32_t serving;
+    uint32_t handoff_pauses;    /* cost of one handoff, in cpu_pause() units */
+} ticketlock_pb_t;
+
+/* Default handoff cost: about one cross-core cache line transfer */
+#define TICKET_PB_HANDOFF_NS     200
+#define TICKET_PB_DEFAULT_PAUSES 20
+
+#define TICKETLOCK_PB_INITIALIZER {0, 0, TICKET_PB_DEFAULT_PAUSES}
+
+/* Initialize proportional-backoff ticket lock (0 pauses selects the default) */
+static inline void ticket_pb_init(ticketlock_pb_t *lock, uint32_t handoff_pauses)
+{
+    atomic_store(&lock->next_ticket, 0);
+    atomic_store(&lock->serving, 0);
+    lock->handoff_pauses = handoff_pauses ? handoff_pauses : TICKET_PB_DEFAULT_PAUSES;
+}
+
+/*
+ * Calibrate the per-handoff delay against this CPU's cpu_pause() latency,
+ * which ranges from a few to over a hundred cycles between cores.
+ * handoff_ns of 0 selects TICKET_PB_HANDOFF_NS.  Returns the new setting.
+ */
+static inline uint32_t ticket_pb_calibrate(ticketlock_pb_t *lock, uint32_t handoff_ns)
+{
+    const uint32_t rounds = 4096;
+    uint64_t start, elapsed;
+    uint32_t i, pauses;
+
+    if (handoff_ns == 0) {
+        handoff_ns = TICKET_PB_HANDOFF_NS;
+    }
+
+    start = cas_clock_ns();
+    for (i = 0; i < rounds; i++) {
+        cpu_pause();
+    }
+    elapsed = cas_clock_ns() - start;
+
+    pauses = elapsed ? (uint32_t)((uint64_t)handoff_ns * rounds / elapsed) : 0;
+    lock->handoff_pauses = pauses ? pauses : 1;
+    return lock->handoff_pauses;
+}
+
+/* Acquire lock */
+static inline void ticket_pb_lock(ticketlock_pb_t *lock)
+{
+    uint32_t my_ticket = atomic_fetch_add(&lock->next_ticket, 1);
+
+    while (1) {
+        uint32_t distance = my_ticket - atomic_load_acquire(&lock->serving);
+        uint32_t delay;
+
+        if (distance == 0) {
+            return;
+        }
+        CAS_LOCK_POLL_HOOK();
+
+        /* Next in line: poll tightly */
+        if (distance == 1) {
+            cpu_pause();
+            continue;
+        }
+
+        /* Sleep through the handoffs ahead of us */
+        delay = (distance - 1) * lock->handoff_pauses;
+        while (delay--) {
+            cpu_pause();
+        }
+    }
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int ticket_pb_trylock(ticketlock_pb_t *lock)
+{
+    uint32_t serving = atomic_load_acquire(&lock->serving);
+
+    /* Taking the ticket being served means nobody holds or waits */
+    return atomic_cmpxchg_bool(&lock->next_ticket, serving, serving + 1);
+}
+
+/* Release lock */
+static inline void ticket_pb_unlock(ticketlock_pb_t *lock)
+{
+    atomic_store_release(&lock->serving, atomic_load(&lock->serving) + 1);
+}
+
+/*
+ * Partitioned Ticket Lock (Dice)
+ * Grants are spread over PTICKET_SLOTS padded slots indexed by ticket
+ * modulo the slot count, so waiters spin on different cache lines while
+ * the single next_ticket counter keeps FIFO order.  The holder hands over
+ * by writing the next ticket number into that ticket's slot.
+ */
+#define PTICKET_SLOTS 8     /* must be a power of two */
+
+typedef struct {
+    volatile uint32_t grant;
+    char pad[CAS_LOCK_CACHELINE - sizeof(uint32_t)];
+} pticket_slot_t;
+
+typedef struct {
+    volatile uint32_t next_ticket;
+    uint32_t owner_ticket;      /* written by the holder only */
+    char pad[CAS_LOCK_CACHELINE - 2 * sizeof(uint32_t)];
+    pticket_slot_t slots[PTICKET_SLOTS];
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) pticketlock_t;
+
+/* All grants at 0: ticket 0 is granted, everyone else waits */
+#define PTICKETLOCK_INITIALIZER {0}
+
+#define PTICKET_SLOT(lock, ticket) (&(lock)->slots[(ticket) & (PTICKET_SLOTS - 1)])
+
+/* Initialize partitioned ticket lock */
+static inline void pticket_init(pticketlock_t *lock)
+{
+    int i;
+    atomic_store(&lock->next_ticket, 0);
+    lock->owner_ticket = 0;
+    for (i = 0; i < PTICKET_SLOTS; i++) {
+        atomic_store(&lock->slots[i].grant, 0);
+    }
+}
+
+/* Acquire lock */
+static inline void pticket_lock(pticketlock_t *lock)
+{
+    uint32_t my_ticket = atomic_fetch_add(&lock->next_ticket, 1);
+    pticket_slot_t *slot = PTICKET_SLOT(lock, my_ticket);
+
+    while (atomic_load_acquire(&slot->grant) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+    lock->owner_ticket = my_ticket;
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int pticket_trylock(pticketlock_t *lock)
+{
+    uint32_t ticket = atomic_load(&lock->next_ticket);
+
+    /* Ticket already granted and not yet handed out: the lock is free */
+    if (atomic_load_acquire(&PTICKET_SLOT(lock, ticket)->grant) != ticket) {
+        return 0;
+    }
+    if (!atomic_cmpxchg_bool(&lock->next_ticket, ticket, ticket + 1)) {
+        return 0;
+    }
+    lock->owner_ticket = ticket;
+    return 1;
+}
+
+/* Release lock */
+static inline void pticket_unlock(pticketlock_t *lock)
+{
+    uint32_t next = lock->owner_ticket + 1;
+    atomic_store_release(&PTICKET_SLOT(lock, next)->grant, next);
+}
+
+/*
+ * TWA Ticket Lock (Dice & Kogan, "TWA - Ticket Locks Augmented with a
+ * Waiting Array")
+ * Same 8-byte layout as ticketlock_t.  Waiters within TWA_LONG_TERM_THRESHOLD
+ * of the head spin on grant; waiters further back spin on a slot of a
+ * process-wide waiting array hashed by (lock, ticket).  Each unlock bumps
+ * the slot of the ticket that just moved into the short-term window, so a
+ * handoff only disturbs the near waiters and at most one long-term waiter.
+ */
+#define TWA_ARRAY_SIZE          1024    /* must be a power of two */
+#define TWA_LONG_TERM_THRESHOLD 1
+
+typedef struct {
+    volatile uint32_t seq;
+    char pad[CAS_LOCK_CACHELINE - sizeof(uint32_t)];
+} twa_slot_t;
+
+/* Weak so that every translation unit including this header shares one array */
+__attribute__((weak, aligned(CAS_LOCK_CACHELINE)))
+twa_slot_t twa_wait_array[TWA_ARRAY_SIZE];
+
+typedef struct {
+    volatile uint32_t ticket;
+    volatile uint32_t grant;
+} twalock_t;
+
+#define TWALOCK_INITIALIZER {0, 0}
+
+/* Consecutive tickets of one lock map to consecutive slots */
+static inline twa_slot_t *twa_slot(twalock_t *lock, uint32_t ticket)
+{
+    uint32_t hash = (uint32_t)((uintptr_t)lock >> 3) * 0x9E3779B1u + ticket;
+    return &twa_wait_array[hash & (TWA_ARRAY_SIZE - 1)];
+}
+
+/* Initialize TWA lock */
+static inline void twa_init(twalock_t *lock)
+{
+    atomic_store(&lock->ticket, 0);
+    atomic_store(&lock->grant, 0);
+}
+
+/* Acquire lock */
+static inline void twa_lock(twalock_t *lock)
+{
+    uint32_t my_ticket = atomic_fetch_add(&lock->ticket, 1);
+    uint32_t distance = my_ticket - atomic_load_acquire(&lock->grant);
+
+    if (distance == 0) {
+        return;
+    }
+
+    /* Long-term wait on the shared array until we are near the head */
+    if (distance > TWA_LONG_TERM_THRESHOLD) {
+        twa_slot_t *slot = twa_slot(lock, my_ticket);
+
+        while (1) {
+            uint32_t seq = atomic_load_acquire(&slot->seq);
+
+            distance = my_ticket - atomic_load_acquire(&lock->grant);
+            if (distance <= TWA_LONG_TERM_THRESHOLD) {
+                break;
+            }
+            while (atomic_load_acquire(&slot->seq) == seq) {
+                CAS_LOCK_POLL_HOOK();
+                cpu_pause();
+            }
+        }
+    }
+
+    /* Short-term wait on grant */
+    while (atomic_load_acquire(&lock->grant) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int twa_trylock(twalock_t *lock)
+{
+    uint32_t grant = atomic_load_acquire(&lock->grant);
+    return atomic_cmpxchg_bool(&lock->ticket, grant, grant + 1);
+}
+
+/* Release lock */
+static inline void twa_unlock(twalock_t *lock)
+{
+    uint32_t next = atomic_load(&lock->grant) + 1;
+
+    atomic_store_release(&lock->grant, next);
+
+    /* Promote the waiter that just entered the short-term window */
+    atomic_fetch_add(&twa_slot(lock, next + TWA_LONG_TERM_THRESHOLD)->seq, 1);
+}
+
+/*
+ * Single-word Ticket Lock
+ * head (ticket being served) and tail (next ticket) share one 64-bit word:
+ * acquire is one fetch-add on the word, trylock is one CAS, unlock is a
+ * store-release of the head half only, and the state queries are one load.
+ */
+typedef union {
+    volatile uint64_t word;
+    struct {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        volatile uint32_t head;
+        volatile uint32_t tail;
+#else
+        volatile uint32_t tail;
+        volatile uint32_t head;
+#endif
+    };
+} ticketlock64_t;
+
+#define TICKETLOCK64_INITIALIZER {0}
+
+#define TICKET64_TAIL_SHIFT 32
+#define TICKET64_TAIL_INC   (1ULL << TICKET64_TAIL_SHIFT)
+
+#define TICKET64_HEAD(word) ((uint32_t)(word))
+#define TICKET64_TAIL(word) ((uint32_t)((word) >> TICKET64_TAIL_SHIFT))
+
+/* Initialize single-word ticket lock */
+static inline void ticket64_init(ticketlock64_t *lock)
+{
+    atomic_store64(&lock->word, 0);
+}
+
+/* Acquire lock */
+static inline void ticket64_lock(ticketlock64_t *lock)
+{
+    uint64_t old = atomic_fetch_add64(&lock->word, TICKET64_TAIL_INC);
+    uint32_t my_ticket = TICKET64_TAIL(old);
+
+    /* Uncontended: our ticket is already being served */
+    if (TICKET64_HEAD(old) == my_ticket) {
+        return;
+    }
+
+    while (atomic_load_acquire(&lock->head) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
+        cpu_pause();
+    }
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int ticket64_trylock(ticketlock64_t *lock)
+{
+    uint64_t old = atomic_load64(&lock->word);
+
+    if (TICKET64_HEAD(old) != TICKET64_TAIL(old)) {
+        return 0;
+    }
+
+    /* Bumping the tail may carry out of bit 63, which leaves head intact */
+    return atomic_cmpxchg64_bool(&lock->word, old, old + TICKET64_TAIL_INC);
+}
+
+/* Release lock */
+static inline void ticket64_unlock(ticketlock64_t *lock)
+{
+    /* Only the holder writes head, so a plain read is enough */
+    atomic_store_release(&lock->head, atomic_load(&lock->head) + 1);
+}
+
+/* Returns 1 if the lock is held */
+static inline int ticket64_is_locked(ticketlock64_t *lock)
+{
+    uint64_t word = atomic_load64(&lock->word);
+    return TICKET64_HEAD(word) != TICKET64_TAIL(word);
+}
+
+/* Returns 1 if the lock is held and at least one thread is waiting */
+static inline int ticket64_is_contended(ticketlock64_t *lock)
+{
+    uint64_t word = atomic_load64(&lock->word);
+    return (uint32_t)(TICKET64_TAIL(word) - TICKET64_HEAD(word)) > 1;
+}
+
+/*
+ * Compact Ticket Locks of configurable width
+ *
+ * CAS_DEFINE_TICKET_LOCK(name, type) generates a ticket lock whose two
+ * counters are `type` wide, so the whole lock is 2 * sizeof(type) bytes
+ * and can be packed into object headers:
+ *
+ *     CAS_DEFINE_TICKET_LOCK(ticket8,  uint8_t)   ->  ticket8_t,  2 bytes
+ *     CAS_DEFINE_TICKET_LOCK(ticket16, uint16_t)  ->  ticket16_t, 4 bytes
+ *     CAS_DEFINE_TICKET_LOCK(ticket32, uint32_t)  ->  ticket32_t, 8 bytes
+ *
+ * Counters wrap modulo 2^bits, which is harmless as long as fewer than
+ * 2^bits threads hold or wait for the lock at once (255 for uint8_t).
+ * The struct is aligned to its own size so trylock can CAS both counters
+ * in one go.  The helpers in atomic.h are uint32_t only, so the generated
+ * functions use the type-generic GCC builtins directly.
+ */
+#define CAS_TICKET_LOCK_INITIALIZER {0, 0}
+
+#define CAS_DEFINE_TICKET_LOCK(name, type)                                  \
+typedef struct {                                                            \
+    type next_ticket;                                                       \
+    type serving;                                                           \
+} __attribute__((aligned(2 * sizeof(type)))) name##_t;                      \
+                                                                            \
+_Static_assert(sizeof(name##_t) == 2 * sizeof(type),                        \
+               #name "_t must pack both counters");                         \
+                                                                            \
+static inline void name##_init(name##_t *lock)                              \
+{                                                                           \
+    __atomic_store_n(&lock->next_ticket, (type)0, __ATOMIC_RELAXED);        \
+    __atomic_store_n(&lock->serving, (type)0, __ATOMIC_RELAXED);            \
+}                                                                           \
+                                                                            \
+static inline void name##_lock(name##_t *lock)                              \
+{                                                                           \
+    type my_ticket = __atomic_fetch_add(&lock->next_ticket, (type)1,        \
+                                        __ATOMIC_ACQ_REL);                  \
+                                                                            \
+    while (__atomic_load_n(&lock->serving, __ATOMIC_ACQUIRE) != my_ticket) {\
+        CAS_LOCK_POLL_HOOK();                                               \
+        cpu_pause();                                                        \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+/* Returns 1 on success, 0 on failure */                                    \
+static inline int name##_trylock(name##_t *lock)                            \
+{                                                                           \
+    name##_t old, claimed;                                                  \
+                                                                            \
+    __atomic_load(lock, &old, __ATOMIC_RELAXED);                            \
+    if (old.next_ticket != old.serving) {                                   \
+        return 0;                                                           \
+    }                                                                       \
+    claimed = old;                                                          \
+    claimed.next_ticket = (type)(old.next_ticket + 1);                      \
+    return __atomic_compare_exchange(lock, &old, &claimed, 0,               \
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);   \
+}                                                                           \
+                                                                            \
+static inline void name##_unlock(name##_t *lock)                            \
+{                                                                           \
+    /* Only the holder writes serving, so a plain read is enough */         \
+    type next = (type)(__atomic_load_n(&lock->serving, __ATOMIC_RELAXED) + 1);\
+    __atomic_store_n(&lock->serving, next, __ATOMIC_RELEASE);               \
+}
+
+CAS_DEFINE_TICKET_LOCK(ticket8, uint8_t)
+CAS_DEFINE_TICKET_LOCK(ticket16, uint16_t)
+CAS_DEFINE_TICKET_LOCK(ticket32, uint32_t)
+
 /*
  * Anderson Lock - Array-based queue lock
- * Reduces contention by having each thread spin on a different cache line
+ * Reduces contention by having each thread spin on a different cache line.
+ *
+ * The slot array is allocated through an allocator hook and sized to the
+ * CPU count (rounded up to a power of two) unless a size is given.  Each
+ * slot holds the number of the ticket it has granted, so a slot shared by
+ * more waiters than slots (oversubscription) still admits exactly one.
+ * Statically initialized locks allocate their array on first use.
  */
-#define ANDERSON_LOCK_MAX_THREADS 64
+typedef struct {
+    volatile uint32_t grant;
+    char pad[CAS_LOCK_CACHELINE - sizeof(uint32_t)];
+} anderson_slot_t;
 
 typedef struct {
-    volatile uint32_t next_slot;
-    volatile uint32_t serving_slot;
-    volatile uint32_t flags[ANDERSON_LOCK_MAX_THREADS];
-    uint32_t num_slots;
+    volatile uint32_t next_ticket;
+    uint32_t owner_ticket;              /* written by the holder only */
+    anderson_slot_t *volatile slots;    /* NULL until allocated */
+    volatile uint32_t num_slots;        /* requested size, 0 = CPU count */
+    cas_alloc_fn alloc_fn;              /* NULL = cas_default_alloc */
+    cas_free_fn free_fn;                /* NULL = cas_default_free */
 } anderson_lock_t;
 
-#define ANDERSON_LOCK_INITIALIZER(slots) {0, 0, {[0 ... (slots)-1] = 1}, slots}
+/* slots of 0 sizes the array to the CPU count on first use */
+#define ANDERSON_LOCK_INITIALIZER(slots) \
+    {0, 0, NULL, (slots), NULL, NULL}
 
-/* Initialize Anderson lock */
-static inline void anderson_init(anderson_lock_t *lock, uint32_t num_slots)
+/* Allocate the slot array if nobody has yet; returns NULL on allocation failure */
+static inline anderson_slot_t *anderson_slots(anderson_lock_t *lock)
 {
-    int i;
-    if (num_slots > ANDERSON_LOCK_MAX_THREADS) {
-        num_slots = ANDERSON_LOCK_MAX_THREADS;
+    anderson_slot_t *slots;
+    uint32_t n;
+    size_t size;
+
+    slots = (anderson_slot_t *)atomic_load_ptr_acquire((void *volatile *)&lock->slots);
+    if (slots != NULL) {
+        return slots;
     }
+
+    /* Racing initializers compute the same size; the CAS picks one array */
+    n = atomic_load(&lock->num_slots);
+    n = cas_pow2_roundup(n ? n : cas_num_cpus());
+    size = (size_t)n * sizeof(anderson_slot_t);
+    slots = (anderson_slot_t *)(lock->alloc_fn ? lock->alloc_fn : cas_default_alloc)(
+        size, CAS_LOCK_CACHELINE);
+    if (slots == NULL) {
+        return NULL;
+    }
+    /* All grants at 0: ticket 0 is granted, everyone else waits */
+    memset(slots, 0, size);
+    atomic_store(&lock->num_slots, n);
+
+    if (!atomic_cmpxchg_ptr_bool((void *volatile *)&lock->slots, NULL, slots)) {
+        (lock->free_fn ? lock->free_fn : cas_default_free)(slots);
+        slots = (anderson_slot_t *)atomic_load_ptr_acquire((void *volatile *)&lock->slots);
+    }
+    return slots;
+}
+
+/*
+ * Initialize Anderson lock with a custom allocator (NULL selects the
+ * default).  num_slots of 0 sizes the array to the CPU count.
+ * Returns 0 on success, -1 if the slot array could not be allocated.
+ */
+static inline int anderson_init_alloc(anderson_lock_t *lock, uint32_t num_slots,
+                                      cas_alloc_fn alloc_fn, cas_free_fn free_fn)
+{
+    atomic_store(&lock->next_ticket, 0);
+    lock->owner_ticket = 0;
+    lock->slots = NULL;
     lock->num_slots = num_slots;
-    atomic_store(&lock->next_slot, 0);
-    atomic_store(&lock->serving_slot, 0);
+    lock->alloc_fn = alloc_fn;
+    lock->free_fn = free_fn;
+    return anderson_slots(lock) != NULL ? 0 : -1;
+}
+
+/* Initialize Anderson lock - returns 0 on success, -1 on allocation failure */
+static inline int anderson_init(anderson_lock_t *lock, uint32_t num_slots)
+{
+    return anderson_init_alloc(lock, num_slots, NULL, NULL);
+}
 
-    /* First slot is available, rest are not */
-    for (i = 0; i < num_slots; i++) {
-        atomic_store(&lock->flags[i], (i == 0) ? 1 : 0);
+/* Release the slot array; the lock must be free and unused */
+static inline void anderson_destroy(anderson_lock_t *lock)
+{
+    if (lock->slots != NULL) {
+        (lock->free_fn ? lock->free_fn : cas_default_free)(lock->slots);
+        lock->slots = NULL;
     }
 }
 
-/* Acquire Anderson lock */
+/* Acquire Anderson lock (aborts if a lazily allocated array cannot be had) */
 static inline void anderson_lock(anderson_lock_t *lock)
 {
-    /* Get my slot */
-    uint32_t my_slot = atomic_fetch_add(&lock->next_slot, 1) % lock->num_slots;
+    anderson_slot_t *slots = anderson_slots(lock);
+    uint32_t my_ticket;
+    anderson_slot_t *slot;
+
+    if (slots == NULL) {
+        abort();
+    }
+
+    /* Get my ticket and the slot it is granted through */
+    my_ticket = atomic_fetch_add(&lock->next_ticket, 1);
+    slot = &slots[my_ticket & (lock->num_slots - 1)];
 
-    /* Wait for my slot's flag to be set */
-    while (atomic_load_acquire(&lock->flags[my_slot]) == 0) {
+    /* Wait for my ticket to be granted */
+    while (atomic_load_acquire(&slot->grant) != my_ticket) {
+        CAS_LOCK_POLL_HOOK();
         cpu_pause();
     }
+    lock->owner_ticket = my_ticket;
+}
+
+/* Try to acquire Anderson lock - returns 1 on success, 0 on failure */
+static inline int anderson_trylock(anderson_lock_t *lock)
+{
+    anderson_slot_t *slots = anderson_slots(lock);
+    uint32_t ticket;
+
+    if (slots == NULL) {
+        return 0;
+    }
 
-    /* Clear my flag for the next thread */
-    atomic_store_release(&lock->flags[my_slot], 0);
+    ticket = atomic_load(&lock->next_ticket);
+    if (atomic_load_acquire(&slots[ticket & (lock->num_slots - 1)].grant) != ticket) {
+        return 0;
+    }
+    if (!atomic_cmpxchg_bool(&lock->next_ticket, ticket, ticket + 1)) {
+        return 0;
+    }
+    lock->owner_ticket = ticket;
+    return 1;
 }
 
 /* Release Anderson lock */
 static inline void anderson_unlock(anderson_lock_t *lock)
 {
-    /* Move to next slot and set its flag */
-    uint32_t next_slot = atomic_load(&lock->serving_slot) + 1;
-    atomic_store(&lock->serving_slot, next_slot % lock->num_slots);
-    atomic_store_release(&lock->flags[next_slot % lock->num_slots], 1);
+    /* Grant the next ticket through its slot */
+    uint32_t next = lock->owner_ticket + 1;
+    atomic_store_release(&lock->slots[next & (lock->num_slots - 1)].grant, next);
+}
+
+/*
+ * Anderson Lock with hold-time statistics
+ * Opt-in variant for callers that want anderson_estimated_wait_ns(): the
+ * plain anderson_lock_t plus a lock_stat_t, so only users of the estimate
+ * pay for the sampling.  The holder's ticket is owner_ticket.
+ */
+typedef struct {
+    anderson_lock_t lock;
+    lock_stat_t stat;
+} anderson_stat_lock_t;
+
+#define ANDERSON_STAT_LOCK_INITIALIZER(slots) \
+    {ANDERSON_LOCK_INITIALIZER(slots), LOCK_STAT_INITIALIZER}
+
+/* Returns 0 on success, -1 on allocation failure */
+static inline int anderson_stat_init(anderson_stat_lock_t *lock, uint32_t num_slots)
+{
+    lock_stat_init(&lock->stat);
+    return anderson_init(&lock->lock, num_slots);
+}
+
+static inline void anderson_stat_destroy(anderson_stat_lock_t *lock)
+{
+    anderson_destroy(&lock->lock);
+}
+
+static inline void anderson_stat_lock(anderson_stat_lock_t *lock)
+{
+    anderson_lock(&lock->lock);
+    lock_stat_acquired(&lock->stat, lock->lock.owner_ticket);
+}
+
+/* Try to acquire lock - returns 1 on success, 0 on failure */
+static inline int anderson_stat_trylock(anderson_stat_lock_t *lock)
+{
+    if (!anderson_trylock(&lock->lock)) {
+        return 0;
+    }
+    lock_stat_acquired(&lock->stat, lock->lock.owner_ticket);
+    return 1;
+}
+
+static inline void anderson_stat_unlock(anderson_stat_lock_t *lock)
+{
+    lock_stat_releasing(&lock->stat);
+    anderson_unlock(&lock->lock);
+}
+
+/* Threads holding or waiting for the lock, i.e. ahead of a newcomer */
+static inline uint32_t anderson_queue_length(anderson_stat_lock_t *lock)
+{
+    anderson_slot_t *slots;
+    uint32_t next;
+
+    slots = (anderson_slot_t *)atomic_load_ptr_acquire((void *volatile *)&lock->lock.slots);
+    if (slots == NULL) {
+        return 0;
+    }
+
+    /* The next ticket is already granted: nobody holds the lock */
+    next = atomic_load(&lock->lock.next_ticket);
+    if (atomic_load(&slots[next & (lock->lock.num_slots - 1)].grant) == next) {
+        return 0;
+    }
+    return next - lock->lock.owner_ticket;
+}
+
+/* Estimated wait for a newcomer, 0 until a hold time has been sampled */
+static inline uint64_t anderson_estimated_wait_ns(anderson_stat_lock_t *lock)
+{
+    return lock_stat_estimate_ns(&lock->stat, anderson_queue_length(lock));
 }
 
 #endif /* CAS_LOCK_TICKETLOCK_H */
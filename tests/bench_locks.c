@@ -3,24 +3,89 @@
  * Compares performance of different lock implementations
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
 #include <time.h>
 #include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/* Count spin polls per thread; see CAS_LOCK_POLL_HOOK in atomic.h */
+static __thread uint64_t bench_polls;
+#define CAS_LOCK_POLL_HOOK() (bench_polls++)
 
 #include "../include/atomic.h"
 #include "../include/spinlock.h"
 #include "../include/ticketlock.h"
 #include "../include/rwlock.h"
+#include "../include/bravo.h"
 #include "../include/mcslock.h"
+#include "../include/qspinlock.h"
+#include "../include/cnalock.h"
+#include "../include/hmcslock.h"
+#include "../include/shfllock.h"
+#include "../include/reciplock.h"
+#include "../include/gcr.h"
+#include "../include/scllock.h"
+#include "../include/priolock.h"
 
 /* Benchmark configuration */
+#ifndef BENCH_ITERATIONS
 #define BENCH_ITERATIONS 10000000
+#endif
 #define NUM_THREADS_LIST {1, 2, 4, 8}
 #define NUM_THREAD_CONFIGS 4
 
+/* Scaling scenarios run fewer operations at higher thread counts */
+#define SCALING_ITERATIONS (BENCH_ITERATIONS / 10)
+#define SCALING_THREADS_LIST {8, 16, 32, 64}
+
+/* Fairness runs are timed rather than counted */
+#define FAIRNESS_MS 200
+
+/* Admission control: critical section (and refusal) length, shedding threshold */
+#define ADMISSION_CS_PAUSES 200
+#define ADMISSION_THRESHOLDS_NS {2000, 20000}
+
+/* Reader-writer mixes, in per-mille reads */
+#define RW_READ_PERMILLE_LIST {500, 900, 990, 999}
+#define RW_THREADS_LIST {8, 32}
+
+/* NUMA handoffs: threads are split evenly across this many fake nodes */
+#define NUMA_FAKE_NODES 2
+
+/* Multi-lock scenario: a table of locks, several held at once */
+#define MULTI_LOCK_COUNT 64
+#define MULTI_LOCK_HELD_LIST {1, 4}
+
+/* Malthusian scenario: per-thread data touched between acquisitions */
+#define MALTH_PRIVATE_BYTES (64 * 1024)
+#define MALTH_PRIVATE_TOUCHES 8
+
+/* Mixed critical sections: half the threads hold the lock this much longer */
+#define MIXED_CS_SHORT_PAUSES 20
+#define MIXED_CS_LONG_PAUSES 2000
+#define MIXED_THREADS_LIST {4, 8}
+
+/* Priority scenario: high-priority threads against background threads */
+#define PRIO_HIGH_THREADS 2
+#define PRIO_BACKGROUND_LIST {2, 6}
+#define PRIO_BACKGROUND_CS_PAUSES 200
+#define PRIO_HIGH_THINK_PAUSES 2000
+#define PRIO_MAX_SAMPLES 100000
+
+/* Oversubscription scenario: threads per online CPU */
+#define OVERSUB_FACTORS_LIST {2, 4}
+
 /* Time measurement */
 static uint64_t nanos(void)
 {
@@ -34,6 +99,7 @@ typedef struct {
     const char *name;
     uint64_t ns;
     double ops_per_sec;
+    uint64_t polls;
 } bench_result_t;
 
 /* Shared counter */
@@ -171,6 +237,183 @@ static bench_result_t bench_ticketlock(int num_threads)
     return result;
 }
 
+/* ==================== Single-word Ticket Lock Benchmark ==================== */
+
+static ticketlock64_t g_ticket64_lock;
+
+static void* ticketlock64_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        ticket64_lock(&g_ticket64_lock);
+        counter++;
+        ticket64_unlock(&g_ticket64_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_ticketlock64(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    ticket64_init(&g_ticket64_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, ticketlock64_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "Ticket64 Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Partitioned Ticket Lock Benchmark ==================== */
+
+static pticketlock_t g_pticket_lock;
+
+static void* pticketlock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        pticket_lock(&g_pticket_lock);
+        counter++;
+        pticket_unlock(&g_pticket_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_pticketlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    pticket_init(&g_pticket_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, pticketlock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "PTicket Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== TWA Ticket Lock Benchmark ==================== */
+
+static twalock_t g_twa_lock;
+
+static void* twalock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        twa_lock(&g_twa_lock);
+        counter++;
+        twa_unlock(&g_twa_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_twalock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    twa_init(&g_twa_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, twalock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "TWA Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Anderson Lock Benchmark ==================== */
+
+static anderson_lock_t g_anderson_lock;
+
+static void* andersonlock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        anderson_lock(&g_anderson_lock);
+        counter++;
+        anderson_unlock(&g_anderson_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_andersonlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    anderson_init(&g_anderson_lock, 0);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, andersonlock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+    anderson_destroy(&g_anderson_lock);
+
+    bench_result_t result = {
+        .name = "Anderson Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
 /* ==================== MCS Lock Benchmark ==================== */
 
 static mcs_lock_t g_mcs_lock;
@@ -184,9 +427,9 @@ static void* mcslock_bench_thread(void *arg)
     mcs_node_init(&mcs_local_node);
 
     for (i = 0; i < iterations; i++) {
-        mcs_lock(&g_mcs_lock, &mcs_local_node);
+        mcs_lock_node(&g_mcs_lock, &mcs_local_node);
         counter++;
-        mcs_unlock(&g_mcs_lock, &mcs_local_node);
+        mcs_unlock_node(&g_mcs_lock, &mcs_local_node);
     }
     return NULL;
 }
@@ -218,25 +461,23 @@ static bench_result_t bench_mcslock(int num_threads)
     return result;
 }
 
-/* ==================== RWLock Benchmark ==================== */
-
-static rwlock_t rw_lock;
+/* ==================== Implicit-node MCS Lock Benchmark ==================== */
 
-static void* rwlock_bench_thread(void *arg)
+/* Same lock as above; the difference is the per-acquisition TLS lookup */
+static void* mcslock_tls_bench_thread(void *arg)
 {
     uint64_t iterations = *(uint64_t*)arg;
     uint64_t i;
 
-    /* Benchmark as write lock (exclusive) */
     for (i = 0; i < iterations; i++) {
-        rw_write_lock(&rw_lock);
+        mcs_lock(&g_mcs_lock);
         counter++;
-        rw_write_unlock(&rw_lock);
+        mcs_unlock(&g_mcs_lock);
     }
     return NULL;
 }
 
-static bench_result_t bench_rwlock(int num_threads)
+static bench_result_t bench_mcslock_tls(int num_threads)
 {
     pthread_t threads[num_threads];
     uint64_t iterations = BENCH_ITERATIONS / num_threads;
@@ -244,11 +485,11 @@ static bench_result_t bench_rwlock(int num_threads)
     int i;
 
     counter = 0;
-    rw_init(&rw_lock);
+    mcs_init(&g_mcs_lock);
 
     start = nanos();
     for (i = 0; i < num_threads; i++) {
-        pthread_create(&threads[i], NULL, rwlock_bench_thread, &iterations);
+        pthread_create(&threads[i], NULL, mcslock_tls_bench_thread, &iterations);
     }
     for (i = 0; i < num_threads; i++) {
         pthread_join(threads[i], NULL);
@@ -256,54 +497,1935 @@ static bench_result_t bench_rwlock(int num_threads)
     end = nanos();
 
     bench_result_t result = {
-        .name = "RWLock (write)",
+        .name = "MCS Lock (TLS)",
         .ns = end - start,
         .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
     };
     return result;
 }
 
-/* ==================== Main Benchmark Runner ==================== */
+/* ==================== Parking MCS Lock Benchmark ==================== */
 
-typedef bench_result_t (*bench_fn)(int);
+static mcs_park_lock_t g_mcs_park_lock;
+static __thread mcs_park_node_t mcs_park_local_node;
 
-int main(int argc, char *argv[])
+static void* mcs_park_bench_thread(void *arg)
 {
-    (void)argc;
-    (void)argv;
-    int thread_counts[] = {1, 2, 4, 8};
-    int num_configs = 4;
-    int i, j;
-    bench_fn benches[] = {
-        bench_spinlock,
-        bench_tatas_lock,
-        bench_ticketlock,
-        /* MCS lock temporarily disabled - needs 64-bit atomic pointer support */
-        /* bench_mcslock, */
-        bench_rwlock,
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        mcs_park_lock(&g_mcs_park_lock, &mcs_park_local_node);
+        counter++;
+        mcs_park_unlock(&g_mcs_park_lock, &mcs_park_local_node);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_mcs_park(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    mcs_park_init(&g_mcs_park_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, mcs_park_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "MCS-park Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
     };
-    int num_benches = sizeof(benches) / sizeof(benches[0]);
+    return result;
+}
 
-    printf("==========================================================\n");
-    printf("CAS Lock Library - Performance Benchmarks\n");
-    printf("==========================================================\n\n");
+/* ==================== Hemlock Benchmark ==================== */
 
-    printf("Total operations: %d per benchmark\n\n", BENCH_ITERATIONS);
+static hemlock_t g_hemlock;
 
-    printf("%-15s | %8s | %12s | %12s\n", "Lock Type", "Threads", "Time (ms)", "Ops/sec");
-    printf("----------------------------------------------------------\n");
+static void* hemlock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
 
-    for (j = 0; j < num_benches; j++) {
-        for (i = 0; i < num_configs; i++) {
-            bench_result_t result = benches[j](thread_counts[i]);
-            printf("%-15s | %8d | %12.2f | %12.0f\n",
-                   result.name,
-                   thread_counts[i],
-                   result.ns / 1000000.0,
-                   result.ops_per_sec);
-        }
-        printf("----------------------------------------------------------\n");
+    for (i = 0; i < iterations; i++) {
+        hemlock_lock(&g_hemlock);
+        counter++;
+        hemlock_unlock(&g_hemlock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_hemlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    hemlock_init(&g_hemlock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, hemlock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
     }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "Hemlock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== CLH Lock Benchmark ==================== */
+
+static clh_lock_t g_clh_lock;
+static clh_node_t clh_bench_nodes[8];
+
+typedef struct {
+    uint64_t iterations;
+    clh_node_t *node;
+} clh_bench_arg_t;
+
+static void* clhlock_bench_thread(void *arg)
+{
+    clh_bench_arg_t *a = (clh_bench_arg_t *)arg;
+    clh_node_t *node = a->node;
+    uint64_t i;
+
+    for (i = 0; i < a->iterations; i++) {
+        clh_lock(&g_clh_lock, &node);
+        counter++;
+        clh_unlock(&g_clh_lock, &node);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_clhlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    clh_bench_arg_t args[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    /* Safe to reset: every thread below starts from a fresh node */
+    clh_init(&g_clh_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        args[i].iterations = iterations;
+        args[i].node = &clh_bench_nodes[i];
+        clh_node_init(args[i].node);
+        pthread_create(&threads[i], NULL, clhlock_bench_thread, &args[i]);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "CLH Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Abortable Queue Lock Benchmarks ==================== */
+
+/* Timeouts never fire here; this is the cost of being abortable */
+static mcs_try_lock_t g_mcs_try_lock;
+static clh_try_lock_t g_clh_try_lock;
+
+static void* mcs_try_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    mcs_try_node_t *node = NULL;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        mcs_try_lock(&g_mcs_try_lock, &node, UINT64_MAX);
+        counter++;
+        mcs_try_unlock(&g_mcs_try_lock, node);
+    }
+    mcs_try_node_free(node);
+    return NULL;
+}
+
+static bench_result_t bench_mcs_try(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    mcs_try_init(&g_mcs_try_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, mcs_try_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "MCS-try Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+static void* clh_try_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    clh_try_node_t *node = NULL;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        clh_try_lock(&g_clh_try_lock, &node, UINT64_MAX);
+        counter++;
+        clh_try_unlock(&g_clh_try_lock, &node);
+    }
+    clh_try_node_free(node);
+    return NULL;
+}
+
+static bench_result_t bench_clh_try(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    clh_try_init(&g_clh_try_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, clh_try_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "CLH-try Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== HMCS Lock Benchmark ==================== */
+
+static hmcs_lock_t g_hmcs_lock;
+
+static void* hmcslock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    hmcs_node_t node;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        hmcs_lock(&g_hmcs_lock, &node);
+        counter++;
+        hmcs_unlock(&g_hmcs_lock, &node);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_hmcslock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    if (hmcs_init(&g_hmcs_lock, 0) != 0) {
+        abort();
+    }
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, hmcslock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    hmcs_destroy(&g_hmcs_lock);
+
+    bench_result_t result = {
+        .name = "HMCS Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Shuffle Lock Benchmark ==================== */
+
+static shfl_lock_t g_shfl_lock;
+
+static void* shfllock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        shfl_lock(&g_shfl_lock);
+        counter++;
+        shfl_unlock(&g_shfl_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_shfllock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    shfl_init(&g_shfl_lock, NULL);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, shfllock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "Shuffle Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Reciprocating Lock Benchmark ==================== */
+
+static recip_lock_t g_recip_lock;
+
+static void* reciplock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    recip_ctx_t ctx;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        ctx = recip_lock(&g_recip_lock);
+        counter++;
+        recip_unlock(&g_recip_lock, ctx);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_reciplock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    recip_init(&g_recip_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, reciplock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "Recip Lock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Queued Spinlock Benchmark ==================== */
+
+static qspinlock_t g_qspin_lock;
+
+static void* qspinlock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    for (i = 0; i < iterations; i++) {
+        qspin_lock(&g_qspin_lock);
+        counter++;
+        qspin_unlock(&g_qspin_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_qspinlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    qspin_init(&g_qspin_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, qspinlock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "Queued Spinlock",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== RWLock Benchmark ==================== */
+
+static rwlock_t rw_lock;
+
+static void* rwlock_bench_thread(void *arg)
+{
+    uint64_t iterations = *(uint64_t*)arg;
+    uint64_t i;
+
+    /* Benchmark as write lock (exclusive) */
+    for (i = 0; i < iterations; i++) {
+        rw_write_lock(&rw_lock);
+        counter++;
+        rw_write_unlock(&rw_lock);
+    }
+    return NULL;
+}
+
+static bench_result_t bench_rwlock(int num_threads)
+{
+    pthread_t threads[num_threads];
+    uint64_t iterations = BENCH_ITERATIONS / num_threads;
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    rw_init(&rw_lock);
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, rwlock_bench_thread, &iterations);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = "RWLock (write)",
+        .ns = end - start,
+        .ops_per_sec = (double)BENCH_ITERATIONS * 1e9 / (end - start)
+    };
+    return result;
+}
+
+/* ==================== Scaling Scenarios ==================== */
+
+/*
+ * Lock-agnostic runner for the scenarios below: each lock under test is
+ * wrapped in init/lock/unlock shims over a global instance.
+ */
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void (*lock)(void);
+    void (*unlock)(void);
+} bench_lock_ops_t;
+
+typedef struct {
+    const bench_lock_ops_t *ops;
+    uint64_t iterations;
+} bench_ops_arg_t;
+
+static volatile uint64_t total_polls;
+
+static void* ops_bench_thread(void *arg)
+{
+    bench_ops_arg_t *a = (bench_ops_arg_t *)arg;
+    uint64_t i;
+
+    bench_polls = 0;
+    for (i = 0; i < a->iterations; i++) {
+        a->ops->lock();
+        counter++;
+        a->ops->unlock();
+    }
+    __atomic_fetch_add(&total_polls, bench_polls, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static bench_result_t bench_ops(const bench_lock_ops_t *ops, int num_threads, uint64_t total_ops)
+{
+    pthread_t threads[num_threads];
+    bench_ops_arg_t arg = { ops, total_ops / num_threads };
+    uint64_t start, end;
+    int i;
+
+    counter = 0;
+    total_polls = 0;
+    ops->init();
+
+    start = nanos();
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, ops_bench_thread, &arg);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = nanos();
+
+    bench_result_t result = {
+        .name = ops->name,
+        .ns = end - start,
+        .ops_per_sec = (double)total_ops * 1e9 / (end - start),
+        .polls = total_polls
+    };
+    return result;
+}
+
+static void ticket_ops_init(void) { ticket_init(&g_ticket_lock); }
+static void ticket_ops_lock(void) { ticket_lock(&g_ticket_lock); }
+static void ticket_ops_unlock(void) { ticket_unlock(&g_ticket_lock); }
+
+static ticketlock_pb_t g_ticket_pb_lock;
+
+static void ticket_pb_ops_init(void)
+{
+    ticket_pb_init(&g_ticket_pb_lock, 0);
+    ticket_pb_calibrate(&g_ticket_pb_lock, 0);
+}
+static void ticket_pb_ops_lock(void) { ticket_pb_lock(&g_ticket_pb_lock); }
+static void ticket_pb_ops_unlock(void) { ticket_pb_unlock(&g_ticket_pb_lock); }
+
+static void pticket_ops_init(void) { pticket_init(&g_pticket_lock); }
+static void pticket_ops_lock(void) { pticket_lock(&g_pticket_lock); }
+static void pticket_ops_unlock(void) { pticket_unlock(&g_pticket_lock); }
+
+static void twa_ops_init(void) { twa_init(&g_twa_lock); }
+static void twa_ops_lock(void) { twa_lock(&g_twa_lock); }
+static void twa_ops_unlock(void) { twa_unlock(&g_twa_lock); }
+
+static void anderson_ops_init(void)
+{
+    anderson_destroy(&g_anderson_lock);
+    anderson_init(&g_anderson_lock, 0);
+}
+static void anderson_ops_lock(void) { anderson_lock(&g_anderson_lock); }
+static void anderson_ops_unlock(void) { anderson_unlock(&g_anderson_lock); }
+
+static void qspin_ops_init(void) { qspin_init(&g_qspin_lock); }
+static void qspin_ops_lock(void) { qspin_lock(&g_qspin_lock); }
+static void qspin_ops_unlock(void) { qspin_unlock(&g_qspin_lock); }
+
+/* The holder's context lives in TLS between the lock and unlock shims */
+static __thread recip_ctx_t recip_bench_ctx;
+
+static void recip_ops_init(void) { recip_init(&g_recip_lock); }
+static void recip_ops_lock(void) { recip_bench_ctx = recip_lock(&g_recip_lock); }
+static void recip_ops_unlock(void) { recip_unlock(&g_recip_lock, recip_bench_ctx); }
+
+static void tatas_ops_init(void) { tatas_init(&g_tatas_lock); }
+static void tatas_ops_lock(void) { tatas_lock(&g_tatas_lock); }
+static void tatas_ops_unlock(void) { tatas_unlock(&g_tatas_lock); }
+
+static const bench_lock_ops_t tatas_ops = {
+    "TATAS Lock", tatas_ops_init, tatas_ops_lock, tatas_ops_unlock
+};
+static const bench_lock_ops_t ticket_ops = {
+    "Ticket Lock", ticket_ops_init, ticket_ops_lock, ticket_ops_unlock
+};
+static const bench_lock_ops_t ticket_pb_ops = {
+    "Ticket PB", ticket_pb_ops_init, ticket_pb_ops_lock, ticket_pb_ops_unlock
+};
+static const bench_lock_ops_t pticket_ops = {
+    "PTicket Lock", pticket_ops_init, pticket_ops_lock, pticket_ops_unlock
+};
+static const bench_lock_ops_t twa_ops = {
+    "TWA Lock", twa_ops_init, twa_ops_lock, twa_ops_unlock
+};
+static const bench_lock_ops_t anderson_ops = {
+    "Anderson Lock", anderson_ops_init, anderson_ops_lock, anderson_ops_unlock
+};
+static const bench_lock_ops_t qspin_ops = {
+    "Queued Spinlock", qspin_ops_init, qspin_ops_lock, qspin_ops_unlock
+};
+static const bench_lock_ops_t recip_ops = {
+    "Recip Lock", recip_ops_init, recip_ops_lock, recip_ops_unlock
+};
+
+/* Polls of the grant word per acquisition, a proxy for coherence traffic */
+static void run_ticket_traffic(void)
+{
+    const bench_lock_ops_t *locks[] = {
+        &ticket_ops, &ticket_pb_ops, &pticket_ops, &twa_ops, &anderson_ops, &recip_ops
+    };
+    int thread_counts[] = SCALING_THREADS_LIST;
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int i, j;
+
+    printf("\nTicket spin traffic (%d operations)\n\n", SCALING_ITERATIONS);
+    printf("%-15s | %8s | %12s | %12s | %10s\n",
+           "Lock Type", "Threads", "Time (ms)", "Ops/sec", "Polls/op");
+    printf("---------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            bench_result_t result = bench_ops(locks[j], thread_counts[i], SCALING_ITERATIONS);
+            printf("%-15s | %8d | %12.2f | %12.0f | %10.2f\n",
+                   result.name,
+                   thread_counts[i],
+                   result.ns / 1000000.0,
+                   result.ops_per_sec,
+                   (double)result.polls / SCALING_ITERATIONS);
+        }
+        printf("---------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Fairness Scenario ==================== */
+
+static volatile uint32_t bench_stop;
+
+typedef struct {
+    const bench_lock_ops_t *ops;
+    uint64_t acquisitions;
+} fairness_arg_t;
+
+static void* fairness_thread(void *arg)
+{
+    fairness_arg_t *a = (fairness_arg_t *)arg;
+    uint64_t n = 0;
+
+    while (atomic_load(&bench_stop) == 0) {
+        a->ops->lock();
+        counter++;
+        a->ops->unlock();
+        n++;
+    }
+    a->acquisitions = n;
+    return NULL;
+}
+
+/* Per-thread acquisitions over a fixed interval; max/min of 1.00 is perfectly fair */
+static void run_fairness(void)
+{
+    const bench_lock_ops_t *locks[] = { &tatas_ops, &ticket_ops, &twa_ops, &qspin_ops, &recip_ops };
+    int thread_counts[] = SCALING_THREADS_LIST;
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int i, j, t;
+
+    printf("\nFairness (%d ms per run)\n\n", FAIRNESS_MS);
+    printf("%-15s | %8s | %12s | %10s | %10s | %8s\n",
+           "Lock Type", "Threads", "Ops/sec", "Min/thr", "Max/thr", "Max/Min");
+    printf("-----------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = thread_counts[i];
+            pthread_t threads[num_threads];
+            fairness_arg_t args[num_threads];
+            uint64_t start, end, total = 0, min = UINT64_MAX, max = 0;
+
+            counter = 0;
+            bench_stop = 0;
+            locks[j]->init();
+
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = locks[j];
+                args[t].acquisitions = 0;
+                pthread_create(&threads[t], NULL, fairness_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+
+            for (t = 0; t < num_threads; t++) {
+                total += args[t].acquisitions;
+                if (args[t].acquisitions < min) min = args[t].acquisitions;
+                if (args[t].acquisitions > max) max = args[t].acquisitions;
+            }
+
+            printf("%-15s | %8d | %12.0f | %10llu | %10llu | %8.2f\n",
+                   locks[j]->name,
+                   num_threads,
+                   (double)total * 1e9 / (end - start),
+                   (unsigned long long)min,
+                   (unsigned long long)max,
+                   min ? (double)max / min : 0.0);
+        }
+        printf("-----------------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Admission Control Scenario ==================== */
+
+/*
+ * Each arriving request first asks the lock how long it would wait and is
+ * refused instead of queueing when the estimate exceeds the threshold.
+ * Refusing costs as long as serving, so the next request arrives no
+ * sooner after a drop than after a completion, and drops are counted per
+ * arrival rather than per poll of the estimate.
+ */
+typedef struct {
+    const bench_lock_ops_t *ops;
+    uint64_t (*estimated_wait_ns)(void);
+} admission_ops_t;
+
+static void mcs_ops_init(void) { mcs_init(&g_mcs_lock); }
+static void mcs_ops_lock(void) { mcs_lock_node(&g_mcs_lock, &mcs_local_node); }
+static void mcs_ops_unlock(void) { mcs_unlock_node(&g_mcs_lock, &mcs_local_node); }
+
+static const bench_lock_ops_t mcs_ops = {
+    "MCS Lock", mcs_ops_init, mcs_ops_lock, mcs_ops_unlock
+};
+
+/* Estimates need the opt-in statistics variants of the FIFO locks */
+static ticket_stat_lock_t g_ticket_stat_lock;
+static anderson_stat_lock_t g_anderson_stat_lock;
+static mcs_stat_lock_t g_mcs_stat_lock;
+
+static void ticket_stat_ops_init(void) { ticket_stat_init(&g_ticket_stat_lock); }
+static void ticket_stat_ops_lock(void) { ticket_stat_lock(&g_ticket_stat_lock); }
+static void ticket_stat_ops_unlock(void) { ticket_stat_unlock(&g_ticket_stat_lock); }
+static void anderson_stat_ops_init(void)
+{
+    anderson_stat_destroy(&g_anderson_stat_lock);
+    anderson_stat_init(&g_anderson_stat_lock, 0);
+}
+static void anderson_stat_ops_lock(void) { anderson_stat_lock(&g_anderson_stat_lock); }
+static void anderson_stat_ops_unlock(void) { anderson_stat_unlock(&g_anderson_stat_lock); }
+static void mcs_stat_ops_init(void) { mcs_stat_init(&g_mcs_stat_lock); }
+static void mcs_stat_ops_lock(void) { mcs_stat_lock(&g_mcs_stat_lock, &mcs_local_node); }
+static void mcs_stat_ops_unlock(void) { mcs_stat_unlock(&g_mcs_stat_lock, &mcs_local_node); }
+
+static const bench_lock_ops_t ticket_stat_ops = {
+    "Ticket+stats", ticket_stat_ops_init, ticket_stat_ops_lock, ticket_stat_ops_unlock
+};
+static const bench_lock_ops_t anderson_stat_ops = {
+    "Anderson+stats", anderson_stat_ops_init, anderson_stat_ops_lock, anderson_stat_ops_unlock
+};
+static const bench_lock_ops_t mcs_stat_ops = {
+    "MCS+stats", mcs_stat_ops_init, mcs_stat_ops_lock, mcs_stat_ops_unlock
+};
+
+static uint64_t ticket_ops_wait(void) { return ticket_estimated_wait_ns(&g_ticket_stat_lock); }
+static uint64_t anderson_ops_wait(void) { return anderson_estimated_wait_ns(&g_anderson_stat_lock); }
+static uint64_t mcs_ops_wait(void) { return mcs_estimated_wait_ns(&g_mcs_stat_lock); }
+
+static const admission_ops_t admission_locks[] = {
+    { &ticket_stat_ops, ticket_ops_wait },
+    { &anderson_stat_ops, anderson_ops_wait },
+    { &mcs_stat_ops, mcs_ops_wait },
+};
+
+typedef struct {
+    const admission_ops_t *ops;
+    uint64_t threshold_ns;
+    uint64_t completed;
+    uint64_t dropped;
+} admission_arg_t;
+
+static void* admission_thread(void *arg)
+{
+    admission_arg_t *a = (admission_arg_t *)arg;
+    int i;
+
+    while (atomic_load(&bench_stop) == 0) {
+        if (a->threshold_ns && a->ops->estimated_wait_ns() > a->threshold_ns) {
+            for (i = 0; i < ADMISSION_CS_PAUSES; i++) {
+                cpu_pause();
+            }
+            a->dropped++;
+            continue;
+        }
+        a->ops->ops->lock();
+        counter++;
+        for (i = 0; i < ADMISSION_CS_PAUSES; i++) {
+            cpu_pause();
+        }
+        a->ops->ops->unlock();
+        a->completed++;
+    }
+    return NULL;
+}
+
+static void run_admission(void)
+{
+    uint64_t thresholds[] = ADMISSION_THRESHOLDS_NS;
+    int thread_counts[] = SCALING_THREADS_LIST;
+    int num_thresholds = sizeof(thresholds) / sizeof(thresholds[0]);
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(admission_locks) / sizeof(admission_locks[0]);
+    int i, j, k, t;
+
+    printf("\nAdmission control (%d ms per run, threshold 0 = never drop)\n\n", FAIRNESS_MS);
+    printf("%-15s | %8s | %10s | %12s | %12s | %8s\n",
+           "Lock Type", "Threads", "Thresh(ns)", "Done/sec", "Dropped/sec", "Drop %");
+    printf("-----------------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            for (k = -1; k < num_thresholds; k++) {
+                int num_threads = thread_counts[i];
+                pthread_t threads[num_threads];
+                admission_arg_t args[num_threads];
+                uint64_t start, end, done = 0, dropped = 0;
+                uint64_t threshold = k < 0 ? 0 : thresholds[k];
+                double secs;
+
+                counter = 0;
+                bench_stop = 0;
+                admission_locks[j].ops->init();
+
+                start = nanos();
+                for (t = 0; t < num_threads; t++) {
+                    args[t].ops = &admission_locks[j];
+                    args[t].threshold_ns = threshold;
+                    args[t].completed = 0;
+                    args[t].dropped = 0;
+                    pthread_create(&threads[t], NULL, admission_thread, &args[t]);
+                }
+                usleep(FAIRNESS_MS * 1000);
+                atomic_store_release(&bench_stop, 1);
+                for (t = 0; t < num_threads; t++) {
+                    pthread_join(threads[t], NULL);
+                }
+                end = nanos();
+
+                for (t = 0; t < num_threads; t++) {
+                    done += args[t].completed;
+                    dropped += args[t].dropped;
+                }
+                secs = (end - start) / 1e9;
+
+                printf("%-15s | %8d | %10llu | %12.0f | %12.0f | %8.2f\n",
+                       admission_locks[j].ops->name,
+                       num_threads,
+                       (unsigned long long)threshold,
+                       done / secs,
+                       dropped / secs,
+                       done + dropped ? 100.0 * dropped / (done + dropped) : 0.0);
+            }
+        }
+        printf("-----------------------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Reader-Writer Mix Scenario ==================== */
+
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void (*read_lock)(void);
+    void (*read_unlock)(void);
+    void (*write_lock)(void);
+    void (*write_unlock)(void);
+} bench_rw_ops_t;
+
+static rwlock_ticket_t g_rw_ticket_lock;
+
+static void rw_ops_init(void) { rw_init(&rw_lock); }
+static void rw_ops_read_lock(void) { rw_read_lock(&rw_lock); }
+static void rw_ops_read_unlock(void) { rw_read_unlock(&rw_lock); }
+static void rw_ops_write_lock(void) { rw_write_lock(&rw_lock); }
+static void rw_ops_write_unlock(void) { rw_write_unlock(&rw_lock); }
+
+static void rw_ticket_ops_init(void) { rw_ticket_init(&g_rw_ticket_lock); }
+static void rw_ticket_ops_read_lock(void) { rw_ticket_read_lock(&g_rw_ticket_lock); }
+static void rw_ticket_ops_read_unlock(void) { rw_ticket_read_unlock(&g_rw_ticket_lock); }
+static void rw_ticket_ops_write_lock(void) { rw_ticket_write_lock(&g_rw_ticket_lock); }
+static void rw_ticket_ops_write_unlock(void) { rw_ticket_write_unlock(&g_rw_ticket_lock); }
+
+/* BRAVO over the plain RWLock; the read slot is kept per thread */
+static rwlock_t g_bravo_inner;
+static bravo_lock_t g_bravo_lock;
+static __thread bravo_slot_t *bravo_bench_slot;
+
+static void bravo_ops_init(void) { rw_init(&g_bravo_inner); bravo_init_rw(&g_bravo_lock, &g_bravo_inner); }
+static void bravo_ops_read_lock(void) { bravo_bench_slot = bravo_read_lock(&g_bravo_lock); }
+static void bravo_ops_read_unlock(void) { bravo_read_unlock(&g_bravo_lock, bravo_bench_slot); }
+static void bravo_ops_write_lock(void) { bravo_write_lock(&g_bravo_lock); }
+static void bravo_ops_write_unlock(void) { bravo_write_unlock(&g_bravo_lock); }
+
+/* Big-reader lock; the read slot is kept per thread */
+static rwlock_br_t g_rw_br_lock;
+static __thread uint32_t rw_br_bench_slot;
+
+static void rw_br_ops_init(void)
+{
+    if (g_rw_br_lock.slots != NULL) {
+        rw_br_destroy(&g_rw_br_lock);
+    }
+    if (rw_br_init(&g_rw_br_lock, 0) != 0) {
+        fprintf(stderr, "brlock: slot allocation failed\n");
+        exit(1);
+    }
+}
+static void rw_br_ops_read_lock(void) { rw_br_bench_slot = rw_br_read_lock(&g_rw_br_lock); }
+static void rw_br_ops_read_unlock(void) { rw_br_read_unlock(&g_rw_br_lock, rw_br_bench_slot); }
+static void rw_br_ops_write_lock(void) { rw_br_write_lock(&g_rw_br_lock); }
+static void rw_br_ops_write_unlock(void) { rw_br_write_unlock(&g_rw_br_lock); }
+
+static const bench_rw_ops_t rw_ops = {
+    "RWLock", rw_ops_init, rw_ops_read_lock, rw_ops_read_unlock,
+    rw_ops_write_lock, rw_ops_write_unlock
+};
+static const bench_rw_ops_t rw_ticket_ops = {
+    "Ticket RWLock", rw_ticket_ops_init, rw_ticket_ops_read_lock, rw_ticket_ops_read_unlock,
+    rw_ticket_ops_write_lock, rw_ticket_ops_write_unlock
+};
+static const bench_rw_ops_t rw_br_ops = {
+    "BR RWLock", rw_br_ops_init, rw_br_ops_read_lock, rw_br_ops_read_unlock,
+    rw_br_ops_write_lock, rw_br_ops_write_unlock
+};
+static const bench_rw_ops_t bravo_ops = {
+    "BRAVO RWLock", bravo_ops_init, bravo_ops_read_lock, bravo_ops_read_unlock,
+    bravo_ops_write_lock, bravo_ops_write_unlock
+};
+
+typedef struct {
+    const bench_rw_ops_t *ops;
+    uint32_t read_permille;
+    uint32_t seed;
+    uint64_t ops_done;
+    uint64_t max_read_wait;
+    uint64_t max_write_wait;
+} rw_mix_arg_t;
+
+/* xorshift32, per thread */
+static inline uint32_t bench_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void* rw_mix_thread(void *arg)
+{
+    rw_mix_arg_t *a = (rw_mix_arg_t *)arg;
+    uint64_t start, wait;
+    uint32_t value;
+
+    while (atomic_load(&bench_stop) == 0) {
+        if (bench_rand(&a->seed) % 1000 < a->read_permille) {
+            start = nanos();
+            a->ops->read_lock();
+            wait = nanos() - start;
+            value = counter;
+            a->ops->read_unlock();
+            if (wait > a->max_read_wait) a->max_read_wait = wait;
+        } else {
+            start = nanos();
+            a->ops->write_lock();
+            wait = nanos() - start;
+            counter++;
+            a->ops->write_unlock();
+            if (wait > a->max_write_wait) a->max_write_wait = wait;
+        }
+        a->ops_done++;
+    }
+    (void)value;
+    return NULL;
+}
+
+/* Throughput and worst-case acquisition wait per class */
+static void run_rw_mix(void)
+{
+    const bench_rw_ops_t *locks[] = { &rw_ops, &rw_ticket_ops, &bravo_ops, &rw_br_ops };
+    uint32_t read_permilles[] = RW_READ_PERMILLE_LIST;
+    int thread_counts[] = RW_THREADS_LIST;
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int num_mixes = sizeof(read_permilles) / sizeof(read_permilles[0]);
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int i, j, k, t;
+
+    printf("\nReader-writer mix (%d ms per run)\n\n", FAIRNESS_MS);
+    printf("%-15s | %8s | %7s | %12s | %14s | %14s\n",
+           "Lock Type", "Threads", "Read %", "Ops/sec", "Max rd wait us", "Max wr wait us");
+    printf("----------------------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            for (k = 0; k < num_mixes; k++) {
+                int num_threads = thread_counts[i];
+                pthread_t threads[num_threads];
+                rw_mix_arg_t args[num_threads];
+                uint64_t start, end, total = 0, max_rd = 0, max_wr = 0;
+
+                counter = 0;
+                bench_stop = 0;
+                locks[j]->init();
+
+                start = nanos();
+                for (t = 0; t < num_threads; t++) {
+                    memset(&args[t], 0, sizeof(args[t]));
+                    args[t].ops = locks[j];
+                    args[t].read_permille = read_permilles[k];
+                    args[t].seed = 2463534242u + t;
+                    pthread_create(&threads[t], NULL, rw_mix_thread, &args[t]);
+                }
+                usleep(FAIRNESS_MS * 1000);
+                atomic_store_release(&bench_stop, 1);
+                for (t = 0; t < num_threads; t++) {
+                    pthread_join(threads[t], NULL);
+                }
+                end = nanos();
+
+                for (t = 0; t < num_threads; t++) {
+                    total += args[t].ops_done;
+                    if (args[t].max_read_wait > max_rd) max_rd = args[t].max_read_wait;
+                    if (args[t].max_write_wait > max_wr) max_wr = args[t].max_write_wait;
+                }
+
+                printf("%-15s | %8d | %7.1f | %12.0f | %14.1f | %14.1f\n",
+                       locks[j]->name,
+                       num_threads,
+                       read_permilles[k] / 10.0,
+                       (double)total * 1e9 / (end - start),
+                       max_rd / 1000.0,
+                       max_wr / 1000.0);
+            }
+        }
+        printf("----------------------------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== NUMA Handoff Scenario ==================== */
+
+/*
+ * Thread i claims fake node i % NUMA_FAKE_NODES and, given enough CPUs,
+ * is pinned to that node's share of them.  Each acquisition records
+ * whether the previous holder was on another node.
+ */
+static cna_lock_t g_cna_lock;
+static __thread cna_node_t cna_local_node;
+
+static void cna_ops_init(void) { cna_init(&g_cna_lock); }
+static void cna_ops_lock(void) { cna_lock(&g_cna_lock, &cna_local_node); }
+static void cna_ops_unlock(void) { cna_unlock(&g_cna_lock, &cna_local_node); }
+
+static const bench_lock_ops_t cna_ops = {
+    "CNA Lock", cna_ops_init, cna_ops_lock, cna_ops_unlock
+};
+
+static void shfl_ops_init(void) { shfl_init(&g_shfl_lock, shfl_policy_same_key); }
+static void shfl_ops_lock(void) { shfl_lock(&g_shfl_lock); }
+static void shfl_ops_unlock(void) { shfl_unlock(&g_shfl_lock); }
+
+static const bench_lock_ops_t shfl_ops = {
+    "Shuffle Lock", shfl_ops_init, shfl_ops_lock, shfl_ops_unlock
+};
+
+static uint32_t numa_last_node;
+
+typedef struct {
+    const bench_lock_ops_t *ops;
+    uint32_t node;
+    uint64_t acquisitions;
+    uint64_t remote_handoffs;
+} numa_arg_t;
+
+static void numa_pin(uint32_t node)
+{
+#ifdef __linux__
+    uint32_t cpus = cas_num_cpus();
+    uint32_t per_node = cpus / NUMA_FAKE_NODES;
+    cpu_set_t set;
+    uint32_t c;
+
+    if (per_node == 0) {
+        return;
+    }
+    CPU_ZERO(&set);
+    for (c = node * per_node; c < (node + 1) * per_node; c++) {
+        CPU_SET(c, &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)node;
+#endif
+}
+
+static void* numa_thread(void *arg)
+{
+    numa_arg_t *a = (numa_arg_t *)arg;
+    uint64_t n = 0, remote = 0;
+
+    numa_pin(a->node);
+    cna_set_numa_node(a->node);
+    shfl_set_thread_key(a->node);
+
+    while (atomic_load(&bench_stop) == 0) {
+        a->ops->lock();
+        if (numa_last_node != a->node) {
+            remote++;
+            numa_last_node = a->node;
+        }
+        counter++;
+        a->ops->unlock();
+        n++;
+    }
+    a->acquisitions = n;
+    a->remote_handoffs = remote;
+    return NULL;
+}
+
+/* Share of acquisitions whose previous holder ran on another node */
+static void run_numa_handoff(void)
+{
+    const bench_lock_ops_t *locks[] = { &mcs_ops, &cna_ops, &shfl_ops };
+    int thread_counts[] = {8, 16};
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int i, j, t;
+
+    printf("\nNUMA handoffs (%d fake nodes, %d ms per run)\n\n", NUMA_FAKE_NODES, FAIRNESS_MS);
+    printf("%-15s | %8s | %12s | %12s\n", "Lock Type", "Threads", "Ops/sec", "Remote %");
+    printf("----------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = thread_counts[i];
+            pthread_t threads[num_threads];
+            numa_arg_t args[num_threads];
+            uint64_t start, end, total = 0, remote = 0;
+
+            counter = 0;
+            bench_stop = 0;
+            numa_last_node = 0;
+            locks[j]->init();
+
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = locks[j];
+                args[t].node = t % NUMA_FAKE_NODES;
+                pthread_create(&threads[t], NULL, numa_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+
+            for (t = 0; t < num_threads; t++) {
+                total += args[t].acquisitions;
+                remote += args[t].remote_handoffs;
+            }
+
+            printf("%-15s | %8d | %12.0f | %11.2f%%\n",
+                   locks[j]->name,
+                   num_threads,
+                   (double)total * 1e9 / (end - start),
+                   total ? 100.0 * remote / total : 0.0);
+        }
+        printf("----------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Oversubscription Scenario ==================== */
+
+/*
+ * More runnable threads than CPUs: a spinning MCS waiter that is switched
+ * in burns its slice while the waiter ahead of it may be switched out, so
+ * the queue advances at the scheduler's pace.  Parking waiters leave the
+ * CPU to the threads that can make progress, either inside the lock
+ * (MCS-park) or in front of it (GCR, limited to one contender per CPU).
+ */
+static void mcs_park_ops_init(void) { mcs_park_init(&g_mcs_park_lock); }
+static void mcs_park_ops_lock(void) { mcs_park_lock(&g_mcs_park_lock, &mcs_park_local_node); }
+static void mcs_park_ops_unlock(void) { mcs_park_unlock(&g_mcs_park_lock, &mcs_park_local_node); }
+
+static const bench_lock_ops_t mcs_park_ops = {
+    "MCS-park Lock", mcs_park_ops_init, mcs_park_ops_lock, mcs_park_ops_unlock
+};
+
+/* GCR over the spinning locks; its inner locks are separate instances */
+static gcr_lock_t g_gcr_lock;
+static tatas_lock_t g_gcr_tatas;
+static ticketlock_t g_gcr_ticket;
+static mcs_lock_t g_gcr_mcs;
+
+/* One active contender per online CPU */
+static uint32_t gcr_bench_max_active(void)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (uint32_t)online : 1;
+}
+
+static void gcr_tatas_ops_init(void)
+{
+    tatas_init(&g_gcr_tatas);
+    gcr_init_tatas(&g_gcr_lock, &g_gcr_tatas, gcr_bench_max_active());
+}
+static void gcr_ticket_ops_init(void)
+{
+    ticket_init(&g_gcr_ticket);
+    gcr_init_ticket(&g_gcr_lock, &g_gcr_ticket, gcr_bench_max_active());
+}
+static void gcr_mcs_ops_init(void)
+{
+    mcs_init(&g_gcr_mcs);
+    gcr_init_mcs(&g_gcr_lock, &g_gcr_mcs, gcr_bench_max_active());
+}
+static void gcr_ops_lock(void) { gcr_lock(&g_gcr_lock); }
+static void gcr_ops_unlock(void) { gcr_unlock(&g_gcr_lock); }
+
+static const bench_lock_ops_t gcr_tatas_ops = {
+    "GCR(TATAS)", gcr_tatas_ops_init, gcr_ops_lock, gcr_ops_unlock
+};
+static const bench_lock_ops_t gcr_ticket_ops = {
+    "GCR(Ticket)", gcr_ticket_ops_init, gcr_ops_lock, gcr_ops_unlock
+};
+static const bench_lock_ops_t gcr_mcs_ops = {
+    "GCR(MCS)", gcr_mcs_ops_init, gcr_ops_lock, gcr_ops_unlock
+};
+
+static void run_oversubscribed(void)
+{
+    const bench_lock_ops_t *locks[] = {
+        &tatas_ops, &gcr_tatas_ops, &ticket_ops, &gcr_ticket_ops,
+        &mcs_ops, &gcr_mcs_ops, &mcs_park_ops
+    };
+    int factors[] = OVERSUB_FACTORS_LIST;
+    int num_configs = sizeof(factors) / sizeof(factors[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int i, j, t;
+
+    if (online < 1) {
+        online = 1;
+    }
+
+    printf("\nOversubscription (%ld CPUs online, %d ms per run)\n\n", online, FAIRNESS_MS);
+    printf("%-15s | %8s | %12s | %10s | %10s | %8s\n",
+           "Lock Type", "Threads", "Ops/sec", "Min/thr", "Max/thr", "Max/Min");
+    printf("-----------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = (int)online * factors[i];
+            pthread_t threads[num_threads];
+            fairness_arg_t args[num_threads];
+            uint64_t start, end, total = 0, min = UINT64_MAX, max = 0;
+
+            counter = 0;
+            bench_stop = 0;
+            locks[j]->init();
+
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = locks[j];
+                args[t].acquisitions = 0;
+                pthread_create(&threads[t], NULL, fairness_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+
+            for (t = 0; t < num_threads; t++) {
+                total += args[t].acquisitions;
+                if (args[t].acquisitions < min) min = args[t].acquisitions;
+                if (args[t].acquisitions > max) max = args[t].acquisitions;
+            }
+
+            printf("%-15s | %8d | %12.0f | %10llu | %10llu | %8.2f\n",
+                   locks[j]->name,
+                   num_threads,
+                   (double)total * 1e9 / (end - start),
+                   (unsigned long long)min,
+                   (unsigned long long)max,
+                   min ? (double)max / min : 0.0);
+        }
+        printf("-----------------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Multi-lock Scenario ==================== */
+
+/*
+ * Each operation takes `held` adjacent locks from a table of
+ * MULTI_LOCK_COUNT in ascending order, bumps their counters and releases
+ * them.  Queue locks that need a node per held lock pay for finding it;
+ * Hemlock uses one grant word per thread however many locks it holds.
+ */
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void (*lock)(int idx);
+    void (*unlock)(int idx);
+} multi_lock_ops_t;
+
+typedef struct {
+    union {
+        ticketlock_t ticket;
+        mcs_lock_t mcs;
+        qspinlock_t qspin;
+        hemlock_t hem;
+    };
+    uint64_t count;
+} __attribute__((aligned(CAS_LOCK_CACHELINE))) multi_lock_slot_t;
+
+static multi_lock_slot_t multi_locks[MULTI_LOCK_COUNT];
+
+static void multi_ticket_init(void)
+{
+    int i;
+    for (i = 0; i < MULTI_LOCK_COUNT; i++) ticket_init(&multi_locks[i].ticket);
+}
+static void multi_ticket_lock(int idx) { ticket_lock(&multi_locks[idx].ticket); }
+static void multi_ticket_unlock(int idx) { ticket_unlock(&multi_locks[idx].ticket); }
+
+static void multi_mcs_init(void)
+{
+    int i;
+    for (i = 0; i < MULTI_LOCK_COUNT; i++) mcs_init(&multi_locks[i].mcs);
+}
+static void multi_mcs_lock(int idx) { mcs_lock(&multi_locks[idx].mcs); }
+static void multi_mcs_unlock(int idx) { mcs_unlock(&multi_locks[idx].mcs); }
+
+static void multi_qspin_init(void)
+{
+    int i;
+    for (i = 0; i < MULTI_LOCK_COUNT; i++) qspin_init(&multi_locks[i].qspin);
+}
+static void multi_qspin_lock(int idx) { qspin_lock(&multi_locks[idx].qspin); }
+static void multi_qspin_unlock(int idx) { qspin_unlock(&multi_locks[idx].qspin); }
+
+static void multi_hemlock_init(void)
+{
+    int i;
+    for (i = 0; i < MULTI_LOCK_COUNT; i++) hemlock_init(&multi_locks[i].hem);
+}
+static void multi_hemlock_lock(int idx) { hemlock_lock(&multi_locks[idx].hem); }
+static void multi_hemlock_unlock(int idx) { hemlock_unlock(&multi_locks[idx].hem); }
+
+static const multi_lock_ops_t multi_lock_table[] = {
+    { "Ticket Lock", multi_ticket_init, multi_ticket_lock, multi_ticket_unlock },
+    { "MCS Lock (TLS)", multi_mcs_init, multi_mcs_lock, multi_mcs_unlock },
+    { "Queued Spinlock", multi_qspin_init, multi_qspin_lock, multi_qspin_unlock },
+    { "Hemlock", multi_hemlock_init, multi_hemlock_lock, multi_hemlock_unlock },
+};
+
+typedef struct {
+    const multi_lock_ops_t *ops;
+    int held;
+    uint32_t seed;
+    uint64_t ops_done;
+} multi_lock_arg_t;
+
+static void* multi_lock_thread(void *arg)
+{
+    multi_lock_arg_t *a = (multi_lock_arg_t *)arg;
+    uint32_t x = a->seed;
+    uint64_t n = 0;
+    int base, k;
+
+    while (atomic_load(&bench_stop) == 0) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        base = (int)(x % (MULTI_LOCK_COUNT - a->held + 1));
+        for (k = 0; k < a->held; k++) {
+            a->ops->lock(base + k);
+            multi_locks[base + k].count++;
+        }
+        for (k = a->held - 1; k >= 0; k--) {
+            a->ops->unlock(base + k);
+        }
+        n++;
+    }
+    a->ops_done = n;
+    return NULL;
+}
+
+static void run_multi_lock(void)
+{
+    int held_list[] = MULTI_LOCK_HELD_LIST;
+    int thread_counts[] = {4, 16};
+    int num_held = sizeof(held_list) / sizeof(held_list[0]);
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(multi_lock_table) / sizeof(multi_lock_table[0]);
+    int i, j, k, t;
+
+    printf("\nMulti-lock (%d locks, %d ms per run)\n\n", MULTI_LOCK_COUNT, FAIRNESS_MS);
+    printf("%-15s | %8s | %6s | %12s\n", "Lock Type", "Threads", "Held", "Ops/sec");
+    printf("---------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (k = 0; k < num_held; k++) {
+            for (i = 0; i < num_configs; i++) {
+                int num_threads = thread_counts[i];
+                pthread_t threads[num_threads];
+                multi_lock_arg_t args[num_threads];
+                uint64_t start, end, total = 0;
+
+                bench_stop = 0;
+                multi_lock_table[j].init();
+
+                start = nanos();
+                for (t = 0; t < num_threads; t++) {
+                    args[t].ops = &multi_lock_table[j];
+                    args[t].held = held_list[k];
+                    args[t].seed = 2463534242u + t;
+                    pthread_create(&threads[t], NULL, multi_lock_thread, &args[t]);
+                }
+                usleep(FAIRNESS_MS * 1000);
+                atomic_store_release(&bench_stop, 1);
+                for (t = 0; t < num_threads; t++) {
+                    pthread_join(threads[t], NULL);
+                }
+                end = nanos();
+
+                for (t = 0; t < num_threads; t++) {
+                    total += args[t].ops_done;
+                }
+
+                printf("%-15s | %8d | %6d | %12.0f\n",
+                       multi_lock_table[j].name,
+                       num_threads,
+                       held_list[k],
+                       (double)total * 1e9 / (end - start));
+            }
+        }
+        printf("---------------------------------------------------\n");
+    }
+}
+
+/* ==================== Malthusian Scenario ==================== */
+
+/*
+ * Every thread works on a private buffer between acquisitions, so the
+ * more threads circulate through the lock, the more of the LLC their
+ * data competes for.  Culling keeps the circulating set small.  LLC
+ * misses come from perf_event_open() and show as n/a where the kernel
+ * does not allow it.
+ */
+static int llc_counter_open(void)
+{
+#if defined(__linux__) && defined(SYS_perf_event_open)
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;               /* count the threads created after this */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static malth_lock_t g_malth_lock;
+static __thread malth_node_t malth_local_node;
+
+static void malth_ops_init(void) { malth_init(&g_malth_lock); }
+static void malth_ops_lock(void) { malth_lock(&g_malth_lock, &malth_local_node); }
+static void malth_ops_unlock(void) { malth_unlock(&g_malth_lock, &malth_local_node); }
+
+static const bench_lock_ops_t malth_ops = {
+    "Malthusian MCS", malth_ops_init, malth_ops_lock, malth_ops_unlock
+};
+
+typedef struct {
+    const bench_lock_ops_t *ops;
+    uint32_t seed;
+    uint64_t acquisitions;
+} malth_arg_t;
+
+static void* malth_thread(void *arg)
+{
+    malth_arg_t *a = (malth_arg_t *)arg;
+    volatile uint8_t *buf = (volatile uint8_t *)malloc(MALTH_PRIVATE_BYTES);
+    uint32_t x = a->seed;
+    uint64_t n = 0;
+    int k;
+
+    if (buf == NULL) {
+        return NULL;
+    }
+    while (atomic_load(&bench_stop) == 0) {
+        a->ops->lock();
+        counter++;
+        a->ops->unlock();
+        for (k = 0; k < MALTH_PRIVATE_TOUCHES; k++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            buf[(x % (MALTH_PRIVATE_BYTES / CAS_LOCK_CACHELINE)) * CAS_LOCK_CACHELINE]++;
+        }
+        n++;
+    }
+    a->acquisitions = n;
+    free((void *)buf);
+    return NULL;
+}
+
+static void run_malthusian(void)
+{
+    const bench_lock_ops_t *locks[] = { &mcs_ops, &mcs_park_ops, &malth_ops };
+    int thread_counts[] = SCALING_THREADS_LIST;
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int i, j, t;
+
+    printf("\nMalthusian culling (%d KB private data per thread, %d ms per run)\n\n",
+           MALTH_PRIVATE_BYTES / 1024, FAIRNESS_MS);
+    printf("%-15s | %8s | %12s | %14s\n", "Lock Type", "Threads", "Ops/sec", "LLC misses/op");
+    printf("------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = thread_counts[i];
+            pthread_t threads[num_threads];
+            malth_arg_t args[num_threads];
+            uint64_t start, end, total = 0, misses = 0;
+            int fd;
+
+            counter = 0;
+            bench_stop = 0;
+            locks[j]->init();
+
+            fd = llc_counter_open();
+#ifdef __linux__
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = locks[j];
+                args[t].seed = 2463534242u + t;
+                args[t].acquisitions = 0;
+                pthread_create(&threads[t], NULL, malth_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+            if (fd >= 0) {
+                if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+                    misses = 0;
+                }
+                close(fd);
+            }
+
+            for (t = 0; t < num_threads; t++) {
+                total += args[t].acquisitions;
+            }
+
+            if (fd >= 0 && total > 0) {
+                printf("%-15s | %8d | %12.0f | %14.2f\n",
+                       locks[j]->name, num_threads,
+                       (double)total * 1e9 / (end - start),
+                       (double)misses / total);
+            } else {
+                printf("%-15s | %8d | %12.0f | %14s\n",
+                       locks[j]->name, num_threads,
+                       (double)total * 1e9 / (end - start),
+                       "n/a");
+            }
+        }
+        printf("------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Mixed Critical Section Scenario ==================== */
+
+/*
+ * Even threads run long critical sections, odd ones short.  Each thread
+ * records how long it held the lock; an opportunity-fair lock gives every
+ * thread about the same hold time, so long-CS threads do not take it all.
+ * Every thread has its own SCL class of weight 1.
+ */
+static scl_lock_t g_scl_lock;
+static __thread scl_class_t *scl_bench_class;
+
+static void scl_ops_init(void) { scl_init(&g_scl_lock); }
+static void scl_ops_lock(void) { scl_lock(&g_scl_lock, scl_bench_class); }
+static void scl_ops_unlock(void) { scl_unlock(&g_scl_lock, scl_bench_class); }
+
+static const bench_lock_ops_t scl_ops = {
+    "SCL Lock", scl_ops_init, scl_ops_lock, scl_ops_unlock
+};
+
+typedef struct {
+    const bench_lock_ops_t *ops;
+    scl_class_t cls;
+    uint32_t pauses;
+    uint64_t acquisitions;
+    uint64_t hold_ns;
+} mixed_cs_arg_t;
+
+static void* mixed_cs_thread(void *arg)
+{
+    mixed_cs_arg_t *a = (mixed_cs_arg_t *)arg;
+    uint64_t n = 0, held = 0, t0;
+    uint32_t i;
+
+    scl_bench_class = &a->cls;
+    while (atomic_load(&bench_stop) == 0) {
+        a->ops->lock();
+        t0 = nanos();
+        counter++;
+        for (i = 0; i < a->pauses; i++) {
+            cpu_pause();
+        }
+        held += nanos() - t0;
+        a->ops->unlock();
+        n++;
+    }
+    a->acquisitions = n;
+    a->hold_ns = held;
+    return NULL;
+}
+
+static void run_mixed_cs(void)
+{
+    const bench_lock_ops_t *locks[] = { &tatas_ops, &ticket_ops, &scl_ops };
+    int thread_counts[] = MIXED_THREADS_LIST;
+    int num_configs = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    int num_locks = sizeof(locks) / sizeof(locks[0]);
+    int i, j, t;
+
+    printf("\nMixed critical sections (%d vs %d pauses, %d ms per run)\n\n",
+           MIXED_CS_LONG_PAUSES, MIXED_CS_SHORT_PAUSES, FAIRNESS_MS);
+    printf("%-15s | %8s | %12s | %11s | %11s | %8s\n",
+           "Lock Type", "Threads", "Ops/sec", "Long hold%", "Short hold%", "Max/Min");
+    printf("------------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = thread_counts[i];
+            pthread_t threads[num_threads];
+            mixed_cs_arg_t args[num_threads];
+            uint64_t start, end, total = 0, hold_long = 0, hold_short = 0;
+            uint64_t min = UINT64_MAX, max = 0;
+
+            counter = 0;
+            bench_stop = 0;
+            locks[j]->init();
+
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = locks[j];
+                args[t].pauses = t % 2 == 0 ? MIXED_CS_LONG_PAUSES : MIXED_CS_SHORT_PAUSES;
+                /* Only the SCL shims read the class */
+                if (locks[j] == &scl_ops) {
+                    scl_register(&g_scl_lock, &args[t].cls, 1);
+                }
+                pthread_create(&threads[t], NULL, mixed_cs_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+
+            for (t = 0; t < num_threads; t++) {
+                total += args[t].acquisitions;
+                if (t % 2 == 0) {
+                    hold_long += args[t].hold_ns;
+                } else {
+                    hold_short += args[t].hold_ns;
+                }
+                if (args[t].hold_ns < min) min = args[t].hold_ns;
+                if (args[t].hold_ns > max) max = args[t].hold_ns;
+                if (locks[j] == &scl_ops) {
+                    scl_unregister(&g_scl_lock, &args[t].cls);
+                }
+            }
+
+            printf("%-15s | %8d | %12.0f | %10.1f%% | %10.1f%% | %8.2f\n",
+                   locks[j]->name,
+                   num_threads,
+                   (double)total * 1e9 / (end - start),
+                   hold_long + hold_short ? 100.0 * hold_long / (hold_long + hold_short) : 0.0,
+                   hold_long + hold_short ? 100.0 * hold_short / (hold_long + hold_short) : 0.0,
+                   min ? (double)max / min : 0.0);
+        }
+        printf("------------------------------------------------------------------------------\n");
+    }
+}
+
+/* ==================== Priority Latency Scenario ==================== */
+
+/*
+ * A few high-priority threads take the lock briefly and then think, while
+ * background threads hold it back to back for longer.  Each high-priority
+ * acquisition is timed from the call to lock until it returns.  Locks
+ * without classes take both kinds of thread the same way.
+ */
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void (*lock)(int high);
+    void (*unlock)(void);
+} prio_ops_t;
+
+static prio_lock_t g_prio_lock;
+
+static void prio_mcs_init(void) { mcs_init(&g_mcs_lock); }
+static void prio_mcs_lock(int high) { (void)high; mcs_lock(&g_mcs_lock); }
+static void prio_mcs_unlock(void) { mcs_unlock(&g_mcs_lock); }
+
+static void prio_ticket_init(void) { ticket_init(&g_ticket_lock); }
+static void prio_ticket_lock(int high) { (void)high; ticket_lock(&g_ticket_lock); }
+static void prio_ticket_unlock(void) { ticket_unlock(&g_ticket_lock); }
+
+static void prio_prio_init(void) { prio_init(&g_prio_lock); }
+static void prio_prio_lock(int high) { prio_lock(&g_prio_lock, high); }
+static void prio_prio_unlock(void) { prio_unlock(&g_prio_lock); }
+
+static const prio_ops_t prio_locks[] = {
+    { "Ticket Lock", prio_ticket_init, prio_ticket_lock, prio_ticket_unlock },
+    { "MCS Lock (TLS)", prio_mcs_init, prio_mcs_lock, prio_mcs_unlock },
+    { "Priority Lock", prio_prio_init, prio_prio_lock, prio_prio_unlock },
+};
+
+typedef struct {
+    const prio_ops_t *ops;
+    int high;
+    uint64_t acquisitions;
+    uint32_t num_samples;
+    uint64_t *samples;
+} prio_arg_t;
+
+static void* prio_thread(void *arg)
+{
+    prio_arg_t *a = (prio_arg_t *)arg;
+    uint64_t n = 0, t0;
+    int i;
+
+    while (atomic_load(&bench_stop) == 0) {
+        t0 = nanos();
+        a->ops->lock(a->high);
+        if (a->high && a->num_samples < PRIO_MAX_SAMPLES) {
+            a->samples[a->num_samples++] = nanos() - t0;
+        }
+        counter++;
+        if (!a->high) {
+            for (i = 0; i < PRIO_BACKGROUND_CS_PAUSES; i++) {
+                cpu_pause();
+            }
+        }
+        a->ops->unlock();
+        if (a->high) {
+            for (i = 0; i < PRIO_HIGH_THINK_PAUSES; i++) {
+                cpu_pause();
+            }
+        }
+        n++;
+    }
+    a->acquisitions = n;
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run_priority(void)
+{
+    int background[] = PRIO_BACKGROUND_LIST;
+    int num_configs = sizeof(background) / sizeof(background[0]);
+    int num_locks = sizeof(prio_locks) / sizeof(prio_locks[0]);
+    uint64_t *samples = (uint64_t *)malloc(PRIO_HIGH_THREADS * PRIO_MAX_SAMPLES * sizeof(uint64_t));
+    int i, j, t;
+
+    if (samples == NULL) {
+        return;
+    }
+
+    printf("\nHigh-priority acquisition latency (%d high threads, %d ms per run)\n\n",
+           PRIO_HIGH_THREADS, FAIRNESS_MS);
+    printf("%-15s | %10s | %10s | %10s | %10s | %12s\n",
+           "Lock Type", "Background", "p50 (us)", "p99 (us)", "max (us)", "Bg ops/sec");
+    printf("-----------------------------------------------------------------------------------\n");
+
+    for (j = 0; j < num_locks; j++) {
+        for (i = 0; i < num_configs; i++) {
+            int num_threads = PRIO_HIGH_THREADS + background[i];
+            pthread_t threads[num_threads];
+            prio_arg_t args[num_threads];
+            uint64_t start, end, bg_ops = 0;
+            uint32_t n = 0;
+
+            counter = 0;
+            bench_stop = 0;
+            prio_locks[j].init();
+
+            start = nanos();
+            for (t = 0; t < num_threads; t++) {
+                args[t].ops = &prio_locks[j];
+                args[t].high = t < PRIO_HIGH_THREADS;
+                args[t].num_samples = 0;
+                args[t].samples = args[t].high ? samples + (size_t)t * PRIO_MAX_SAMPLES : NULL;
+                pthread_create(&threads[t], NULL, prio_thread, &args[t]);
+            }
+            usleep(FAIRNESS_MS * 1000);
+            atomic_store_release(&bench_stop, 1);
+            for (t = 0; t < num_threads; t++) {
+                pthread_join(threads[t], NULL);
+            }
+            end = nanos();
+
+            /* Gather the high-priority samples at the front of the buffer */
+            for (t = 0; t < num_threads; t++) {
+                if (args[t].high) {
+                    memmove(samples + n, args[t].samples, args[t].num_samples * sizeof(uint64_t));
+                    n += args[t].num_samples;
+                } else {
+                    bg_ops += args[t].acquisitions;
+                }
+            }
+            qsort(samples, n, sizeof(uint64_t), cmp_u64);
+
+            printf("%-15s | %10d | %10.2f | %10.2f | %10.2f | %12.0f\n",
+                   prio_locks[j].name,
+                   background[i],
+                   n ? samples[n / 2] / 1000.0 : 0.0,
+                   n ? samples[(uint64_t)n * 99 / 100] / 1000.0 : 0.0,
+                   n ? samples[n - 1] / 1000.0 : 0.0,
+                   (double)bg_ops * 1e9 / (end - start));
+        }
+        printf("-----------------------------------------------------------------------------------\n");
+    }
+    free(samples);
+}
+
+/* ==================== Main Benchmark Runner ==================== */
+
+typedef bench_result_t (*bench_fn)(int);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    int thread_counts[] = {1, 2, 4, 8};
+    int num_configs = 4;
+    int i, j;
+    bench_fn benches[] = {
+        bench_spinlock,
+        bench_tatas_lock,
+        bench_ticketlock,
+        bench_ticketlock64,
+        bench_pticketlock,
+        bench_twalock,
+        bench_andersonlock,
+        bench_mcslock,
+        bench_mcslock_tls,
+        bench_mcs_park,
+        bench_hemlock,
+        bench_clhlock,
+        bench_mcs_try,
+        bench_clh_try,
+        bench_hmcslock,
+        bench_shfllock,
+        bench_reciplock,
+        bench_qspinlock,
+        bench_rwlock,
+    };
+    int num_benches = sizeof(benches) / sizeof(benches[0]);
+
+    printf("==========================================================\n");
+    printf("CAS Lock Library - Performance Benchmarks\n");
+    printf("==========================================================\n\n");
+
+    printf("Total operations: %d per benchmark\n\n", BENCH_ITERATIONS);
+
+    printf("%-15s | %8s | %12s | %12s\n", "Lock Type", "Threads", "Time (ms)", "Ops/sec");
+    printf("----------------------------------------------------------\n");
+
+    for (j = 0; j < num_benches; j++) {
+        for (i = 0; i < num_configs; i++) {
+            bench_result_t result = benches[j](thread_counts[i]);
+            printf("%-15s | %8d | %12.2f | %12.0f\n",
+                   result.name,
+                   thread_counts[i],
+                   result.ns / 1000000.0,
+                   result.ops_per_sec);
+        }
+        printf("----------------------------------------------------------\n");
+    }
+
+    run_ticket_traffic();
+    run_fairness();
+    run_admission();
+    run_rw_mix();
+    run_numa_handoff();
+    run_oversubscribed();
+    run_multi_lock();
+    run_malthusian();
+    run_mixed_cs();
+    run_priority();
 
     printf("\n==========================================================\n");
     printf("Benchmark Complete\n");
@@ -9,15 +9,30 @@
 #include <unistd.h>
 #include <assert.h>
 
+/* Small tunables so the tests reach the bounded paths */
+#define PRIO_MAX_HIGH_STREAK 4
+#define CNA_INTRA_NODE_THRESHOLD 4
+
 #include "../include/atomic.h"
 #include "../include/spinlock.h"
 #include "../include/ticketlock.h"
 #include "../include/rwlock.h"
+#include "../include/bravo.h"
 #include "../include/mcslock.h"
+#include "../include/qspinlock.h"
+#include "../include/cnalock.h"
+#include "../include/hmcslock.h"
+#include "../include/shfllock.h"
+#include "../include/reciplock.h"
+#include "../include/gcr.h"
+#include "../include/scllock.h"
+#include "../include/priolock.h"
 
 /* Test configuration */
 #define NUM_THREADS 8
+#ifndef ITERATIONS
 #define ITERATIONS 100000
+#endif
 #define TEST_VALUE_MAGIC 42
 
 /* Shared data for testing */
@@ -114,6 +129,328 @@ static void test_ticketlock(void)
     printf("PASSED (counter = %u)\n", ticket_data.counter);
 }
 
+/* ==================== Proportional-backoff Ticket Lock Tests ==================== */
+
+static ticketlock_pb_t g_ticket_pb_lock = TICKETLOCK_PB_INITIALIZER;
+static test_data_t ticket_pb_data;
+
+static void* ticket_pb_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        ticket_pb_lock(&g_ticket_pb_lock);
+        ticket_pb_data.counter++;
+        ticket_pb_unlock(&g_ticket_pb_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_ticket_pb(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Proportional-backoff Ticket Lock... ");
+    fflush(stdout);
+
+    assert(g_ticket_pb_lock.handoff_pauses == TICKET_PB_DEFAULT_PAUSES);
+    assert(ticket_pb_calibrate(&g_ticket_pb_lock, 0) >= 1);
+    assert(ticket_pb_trylock(&g_ticket_pb_lock) == 1);
+    assert(ticket_pb_trylock(&g_ticket_pb_lock) == 0);
+    ticket_pb_unlock(&g_ticket_pb_lock);
+    ticket_pb_data.counter = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, ticket_pb_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(ticket_pb_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u, handoff = %u pauses)\n",
+           ticket_pb_data.counter, g_ticket_pb_lock.handoff_pauses);
+}
+
+/* ==================== Partitioned Ticket Lock Tests ==================== */
+
+/* More threads than slots, so waiters a lap apart share a slot */
+#define PTICKET_TEST_THREADS (2 * PTICKET_SLOTS)
+
+static pticketlock_t g_pticket_lock = PTICKETLOCK_INITIALIZER;
+static test_data_t pticket_data;
+
+static void* pticketlock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        pticket_lock(&g_pticket_lock);
+        pticket_data.counter++;
+        pticket_unlock(&g_pticket_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_pticketlock(void)
+{
+    pthread_t threads[PTICKET_TEST_THREADS];
+    int i;
+
+    printf("Testing Partitioned Ticket Lock... ");
+    fflush(stdout);
+
+    /* Static initializer must be usable as is */
+    assert(pticket_trylock(&g_pticket_lock) == 1);
+    assert(pticket_trylock(&g_pticket_lock) == 0);
+    pticket_unlock(&g_pticket_lock);
+    pticket_data.counter = 0;
+
+    for (i = 0; i < PTICKET_TEST_THREADS; i++) {
+        pthread_create(&threads[i], NULL, pticketlock_thread, NULL);
+    }
+
+    for (i = 0; i < PTICKET_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(pticket_data.counter == PTICKET_TEST_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", pticket_data.counter);
+}
+
+/* ==================== TWA Ticket Lock Tests ==================== */
+
+static twalock_t g_twa_lock = TWALOCK_INITIALIZER;
+static test_data_t twa_data;
+
+static void* twalock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        twa_lock(&g_twa_lock);
+        twa_data.counter++;
+        twa_unlock(&g_twa_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_twalock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing TWA Ticket Lock... ");
+    fflush(stdout);
+
+    assert(sizeof(twalock_t) == 8);
+    assert(twa_trylock(&g_twa_lock) == 1);
+    assert(twa_trylock(&g_twa_lock) == 0);
+    twa_unlock(&g_twa_lock);
+    twa_data.counter = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, twalock_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(twa_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", twa_data.counter);
+}
+
+/* ==================== Single-word Ticket Lock Tests ==================== */
+
+static ticketlock64_t g_ticket64_lock;
+static test_data_t ticket64_data;
+
+static void* ticketlock64_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        if ((i & 7) == 0 && ticket64_trylock(&g_ticket64_lock)) {
+            ticket64_data.counter++;
+            ticket64_unlock(&g_ticket64_lock);
+            continue;
+        }
+        ticket64_lock(&g_ticket64_lock);
+        ticket64_data.counter++;
+        ticket64_unlock(&g_ticket64_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_ticketlock64(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Single-word Ticket Lock... ");
+    fflush(stdout);
+
+    assert(sizeof(ticketlock64_t) == 8);
+
+    /* Tail about to wrap: the carry must not disturb head */
+    g_ticket64_lock.head = 0xFFFFFFFFu;
+    g_ticket64_lock.tail = 0xFFFFFFFFu;
+    assert(ticket64_is_locked(&g_ticket64_lock) == 0);
+    assert(ticket64_trylock(&g_ticket64_lock) == 1);
+    assert(g_ticket64_lock.head == 0xFFFFFFFFu && g_ticket64_lock.tail == 0);
+    assert(ticket64_is_locked(&g_ticket64_lock) == 1);
+    assert(ticket64_is_contended(&g_ticket64_lock) == 0);
+    assert(ticket64_trylock(&g_ticket64_lock) == 0);
+    ticket64_unlock(&g_ticket64_lock);
+    assert(ticket64_is_locked(&g_ticket64_lock) == 0);
+
+    ticket64_init(&g_ticket64_lock);
+    ticket64_data.counter = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, ticketlock64_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(ticket64_data.counter == NUM_THREADS * ITERATIONS);
+    assert(ticket64_is_locked(&g_ticket64_lock) == 0);
+    printf("PASSED (counter = %u)\n", ticket64_data.counter);
+}
+
+/* ==================== Anderson Lock Tests ==================== */
+
+static anderson_lock_t g_anderson_lock = ANDERSON_LOCK_INITIALIZER(0);
+static test_data_t anderson_data;
+static volatile uint32_t anderson_allocs;
+
+static void *counting_alloc(size_t size, size_t align)
+{
+    atomic_inc(&anderson_allocs);
+    return cas_default_alloc(size, align);
+}
+
+static void* andersonlock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        anderson_lock(&g_anderson_lock);
+        anderson_data.counter++;
+        anderson_unlock(&g_anderson_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void run_anderson_threads(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    anderson_data.counter = 0;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, andersonlock_thread, NULL);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(anderson_data.counter == NUM_THREADS * ITERATIONS);
+}
+
+static void test_andersonlock(void)
+{
+    uint32_t cpu_slots;
+
+    printf("Testing Anderson Lock... ");
+    fflush(stdout);
+
+    /* Static initializer: array sized to the CPU count on first use */
+    assert(g_anderson_lock.slots == NULL);
+    assert(anderson_trylock(&g_anderson_lock) == 1);
+    assert(anderson_trylock(&g_anderson_lock) == 0);
+    anderson_unlock(&g_anderson_lock);
+    cpu_slots = g_anderson_lock.num_slots;
+    assert(cpu_slots >= cas_num_cpus());
+    assert((cpu_slots & (cpu_slots - 1)) == 0);
+    run_anderson_threads();
+    anderson_destroy(&g_anderson_lock);
+
+    /* Fewer slots than waiters must still exclude, via the allocator hook */
+    assert(anderson_init_alloc(&g_anderson_lock, 2, counting_alloc, NULL) == 0);
+    assert(anderson_allocs == 1);
+    assert(g_anderson_lock.num_slots == 2);
+    run_anderson_threads();
+    anderson_destroy(&g_anderson_lock);
+
+    printf("PASSED (counter = %u, cpu slots = %u)\n", anderson_data.counter, cpu_slots);
+}
+
+/* ==================== Compact Ticket Lock Tests ==================== */
+
+static ticket8_t g_ticket8_lock;
+static test_data_t ticket8_data;
+
+static void* ticket8_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        ticket8_lock(&g_ticket8_lock);
+        ticket8_data.counter++;
+        ticket8_unlock(&g_ticket8_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_ticket8_wraparound(void)
+{
+    pthread_t threads[NUM_THREADS];
+    uint32_t total = NUM_THREADS * ITERATIONS;
+    int i;
+
+    printf("Testing 8-bit Ticket Lock wraparound... ");
+    fflush(stdout);
+
+    assert(sizeof(ticket8_t) == 2);
+    assert(sizeof(ticket16_t) == 4);
+    assert(sizeof(ticket32_t) == 8);
+
+    /* Start just below the wrap point so it is crossed right away */
+    g_ticket8_lock.next_ticket = 250;
+    g_ticket8_lock.serving = 250;
+    ticket8_data.counter = 0;
+
+    assert(ticket8_trylock(&g_ticket8_lock) == 1);
+    assert(ticket8_trylock(&g_ticket8_lock) == 0);
+    ticket8_unlock(&g_ticket8_lock);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, ticket8_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(ticket8_data.counter == total);
+    /* Both counters advanced by total + 1 modulo 256 */
+    assert(g_ticket8_lock.next_ticket == (uint8_t)(251 + total));
+    assert(g_ticket8_lock.serving == g_ticket8_lock.next_ticket);
+    printf("PASSED (counter = %u, wraps = %u)\n",
+           ticket8_data.counter, (251 + total) / 256);
+}
+
 /* ==================== RWLock Tests ==================== */
 
 static rwlock_t rw_lock;
@@ -169,6 +506,21 @@ static void test_rwlock(void)
     printf("Testing RWLock... ");
     fflush(stdout);
 
+    /* Trylock semantics on the packed word */
+    rw_init(&rw_lock);
+    assert(rw_read_trylock(&rw_lock) == 1);
+    assert(rw_read_trylock(&rw_lock) == 1);
+    assert(rw_write_trylock(&rw_lock) == 0);
+    rw_read_unlock(&rw_lock);
+    rw_read_unlock(&rw_lock);
+    assert(rw_write_trylock(&rw_lock) == 1);
+    assert(rw_write_trylock(&rw_lock) == 0);
+    assert(rw_read_trylock(&rw_lock) == 0);
+    /* A failed write trylock must leave the holder's bit alone */
+    assert(rw_lock.word == RW_WRITER);
+    rw_write_unlock(&rw_lock);
+    assert(rw_lock.word == 0);
+
     rw_init(&rw_lock);
     rw_data.counter = 0;
     rw_data.readers_active = 0;
@@ -191,51 +543,1572 @@ static void test_rwlock(void)
     printf("PASSED (writer count = %u)\n", rw_data.counter);
 }
 
-/* ==================== MCS Lock Tests ==================== */
+/* ==================== Ticket RWLock Tests ==================== */
 
-static mcs_lock_t g_mcs_lock;
-static test_data_t mcs_data;
-static __thread mcs_node_t mcs_local_node;
+static rwlock_ticket_t rw_ticket_lock = RWLOCK_TICKET_INITIALIZER;
+static test_data_t rw_ticket_data;
 
-static void* mcslock_thread(void *arg)
+static void* rw_ticket_reader(void *arg)
 {
     (void)arg;
     int i;
-    mcs_node_init(&mcs_local_node);
+    for (i = 0; i < ITERATIONS / 10; i++) {
+        rw_ticket_read_lock(&rw_ticket_lock);
+        atomic_inc(&rw_ticket_data.readers_active);
+        if (atomic_load(&rw_ticket_data.writer_active) != 0) {
+            rw_ticket_data.error = 1;
+        }
+        atomic_dec(&rw_ticket_data.readers_active);
+        rw_ticket_read_unlock(&rw_ticket_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
 
-    for (i = 0; i < ITERATIONS; i++) {
-        mcs_lock(&g_mcs_lock, &mcs_local_node);
-        mcs_data.counter++;
-        mcs_data.counter *= 2;
-        mcs_data.counter /= 2;
-        mcs_unlock(&g_mcs_lock, &mcs_local_node);
+static void* rw_ticket_writer(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS / 10; i++) {
+        rw_ticket_write_lock(&rw_ticket_lock);
+        if (atomic_xchg(&rw_ticket_data.writer_active, 1) != 0 ||
+            atomic_load(&rw_ticket_data.readers_active) != 0) {
+            rw_ticket_data.error = 1;
+        }
+        rw_ticket_data.counter++;
+        atomic_store(&rw_ticket_data.writer_active, 0);
+        rw_ticket_write_unlock(&rw_ticket_lock);
         cpu_pause();
     }
     return NULL;
 }
 
-static void test_mcslock(void)
+static void test_rwlock_ticket(void)
 {
     pthread_t threads[NUM_THREADS];
     int i;
 
-    printf("Testing MCS Lock... ");
+    printf("Testing Ticket RWLock... ");
     fflush(stdout);
 
-    mcs_init(&g_mcs_lock);
-    mcs_data.counter = 0;
-    mcs_data.error = 0;
+    assert(sizeof(rwlock_ticket_t) == 8);
+
+    /* Readers share, writers exclude both classes */
+    assert(rw_ticket_read_trylock(&rw_ticket_lock) == 1);
+    assert(rw_ticket_read_trylock(&rw_ticket_lock) == 1);
+    assert(rw_ticket_write_trylock(&rw_ticket_lock) == 0);
+    rw_ticket_read_unlock(&rw_ticket_lock);
+    rw_ticket_read_unlock(&rw_ticket_lock);
+    assert(rw_ticket_write_trylock(&rw_ticket_lock) == 1);
+    assert(rw_ticket_read_trylock(&rw_ticket_lock) == 0);
+    assert(rw_ticket_write_trylock(&rw_ticket_lock) == 0);
+    rw_ticket_write_unlock(&rw_ticket_lock);
+
+    rw_ticket_data.counter = 0;
+    rw_ticket_data.readers_active = 0;
+    rw_ticket_data.writer_active = 0;
+    rw_ticket_data.error = 0;
 
     for (i = 0; i < NUM_THREADS; i++) {
-        pthread_create(&threads[i], NULL, mcslock_thread, NULL);
+        if (i % 2 == 0) {
+            pthread_create(&threads[i], NULL, rw_ticket_reader, NULL);
+        } else {
+            pthread_create(&threads[i], NULL, rw_ticket_writer, NULL);
+        }
     }
 
     for (i = 0; i < NUM_THREADS; i++) {
         pthread_join(threads[i], NULL);
     }
 
-    assert(mcs_data.counter == NUM_THREADS * ITERATIONS);
-    printf("PASSED (counter = %u)\n", mcs_data.counter);
+    assert(rw_ticket_data.error == 0);
+    assert(rw_ticket_data.counter == (NUM_THREADS / 2) * (ITERATIONS / 10));
+    printf("PASSED (writer count = %u)\n", rw_ticket_data.counter);
+}
+
+/* ==================== Big-Reader Lock Tests ==================== */
+
+static rwlock_br_t g_rw_br_lock;
+static test_data_t rw_br_data;
+
+static void* rw_br_reader(void *arg)
+{
+    (void)arg;
+    uint32_t slot;
+    int i;
+    for (i = 0; i < ITERATIONS / 10; i++) {
+        slot = rw_br_read_lock(&g_rw_br_lock);
+        atomic_inc(&rw_br_data.readers_active);
+        if (atomic_load(&rw_br_data.writer_active) != 0) {
+            rw_br_data.error = 1;
+        }
+        atomic_dec(&rw_br_data.readers_active);
+        rw_br_read_unlock(&g_rw_br_lock, slot);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void* rw_br_writer(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS / 100; i++) {
+        rw_br_write_lock(&g_rw_br_lock);
+        if (atomic_xchg(&rw_br_data.writer_active, 1) != 0 ||
+            atomic_load(&rw_br_data.readers_active) != 0) {
+            rw_br_data.error = 1;
+        }
+        rw_br_data.counter++;
+        atomic_store(&rw_br_data.writer_active, 0);
+        rw_br_write_unlock(&g_rw_br_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_rw_br(void)
+{
+    pthread_t threads[NUM_THREADS];
+    uint32_t slot, i;
+
+    printf("Testing Big-Reader Lock... ");
+    fflush(stdout);
+
+    /* More slots than CPUs is allowed; 5 rounds up to 8 */
+    assert(rw_br_init(&g_rw_br_lock, 5) == 0);
+    assert(g_rw_br_lock.mask == 7);
+
+    /* A failed write trylock must release the slots it already took */
+    assert(rw_br_read_trylock(&g_rw_br_lock, &slot) == 1);
+    assert(rw_br_write_trylock(&g_rw_br_lock) == 0);
+    for (i = 0; i <= g_rw_br_lock.mask; i++) {
+        assert(g_rw_br_lock.slots[i].lock.word == (i == slot ? 1u : 0u));
+    }
+    rw_br_read_unlock(&g_rw_br_lock, slot);
+    assert(rw_br_write_trylock(&g_rw_br_lock) == 1);
+    assert(rw_br_read_trylock(&g_rw_br_lock, &slot) == 0);
+    rw_br_write_unlock(&g_rw_br_lock);
+    rw_br_destroy(&g_rw_br_lock);
+
+    assert(rw_br_init(&g_rw_br_lock, 0) == 0);
+    rw_br_data.counter = 0;
+    rw_br_data.readers_active = 0;
+    rw_br_data.writer_active = 0;
+    rw_br_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, i % 4 == 0 ? rw_br_writer : rw_br_reader, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(rw_br_data.error == 0);
+    assert(rw_br_data.counter == (NUM_THREADS / 4) * (ITERATIONS / 100));
+    printf("PASSED (writer count = %u, slots = %u)\n", rw_br_data.counter, g_rw_br_lock.mask + 1);
+    rw_br_destroy(&g_rw_br_lock);
+}
+
+/* ==================== BRAVO Wrapper Tests ==================== */
+
+static bravo_lock_t g_bravo;
+static test_data_t bravo_data;
+static volatile uint32_t bravo_fast_reads;
+
+static void* bravo_reader(void *arg)
+{
+    (void)arg;
+    bravo_slot_t *slot;
+    int i;
+    for (i = 0; i < ITERATIONS / 10; i++) {
+        slot = bravo_read_lock(&g_bravo);
+        atomic_inc(&bravo_data.readers_active);
+        if (atomic_load(&bravo_data.writer_active) != 0) {
+            bravo_data.error = 1;
+        }
+        if (slot != NULL) {
+            atomic_inc(&bravo_fast_reads);
+        }
+        atomic_dec(&bravo_data.readers_active);
+        bravo_read_unlock(&g_bravo, slot);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void* bravo_writer(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS / 100; i++) {
+        bravo_write_lock(&g_bravo);
+        if (atomic_xchg(&bravo_data.writer_active, 1) != 0 ||
+            atomic_load(&bravo_data.readers_active) != 0) {
+            bravo_data.error = 1;
+        }
+        bravo_data.counter++;
+        atomic_store(&bravo_data.writer_active, 0);
+        bravo_write_unlock(&g_bravo);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_bravo(void)
+{
+    static rwlock_t rw;
+    static rwlock_phase_t rw_phase;
+    static rwlock_ticket_t rw_ticket;
+    pthread_t threads[NUM_THREADS];
+    bravo_slot_t *slot;
+    int i, k;
+
+    printf("Testing BRAVO wrapper... ");
+    fflush(stdout);
+
+    /* A biased read skips the inner lock; a write revokes the bias */
+    rw_init(&rw);
+    bravo_init_rw(&g_bravo, &rw);
+    slot = bravo_read_lock(&g_bravo);
+    assert(slot != NULL && *slot == &g_bravo);
+    assert(rw.word == 0);
+    bravo_read_unlock(&g_bravo, slot);
+    bravo_write_lock(&g_bravo);
+    assert(g_bravo.rbias == 0);
+    bravo_write_unlock(&g_bravo);
+
+    /* Same wrapper over each kind of inner lock, one writer per four threads */
+    for (k = 0; k < 3; k++) {
+        switch (k) {
+        case 0: rw_init(&rw); bravo_init_rw(&g_bravo, &rw); break;
+        case 1: rw_phase_init(&rw_phase); bravo_init_phase(&g_bravo, &rw_phase); break;
+        default: rw_ticket_init(&rw_ticket); bravo_init_ticket(&g_bravo, &rw_ticket); break;
+        }
+        bravo_data.counter = 0;
+        bravo_data.readers_active = 0;
+        bravo_data.writer_active = 0;
+        bravo_data.error = 0;
+        bravo_fast_reads = 0;
+
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_create(&threads[i], NULL, i % 4 == 0 ? bravo_writer : bravo_reader, NULL);
+        }
+
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        assert(bravo_data.error == 0);
+        assert(bravo_data.counter == (NUM_THREADS / 4) * (ITERATIONS / 100));
+    }
+    printf("PASSED (writer count = %u, fast reads = %u)\n", bravo_data.counter, bravo_fast_reads);
+}
+
+/* ==================== MCS Lock Tests ==================== */
+
+static mcs_lock_t g_mcs_lock;
+static test_data_t mcs_data;
+static __thread mcs_node_t mcs_local_node;
+
+static void* mcslock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    mcs_node_init(&mcs_local_node);
+
+    for (i = 0; i < ITERATIONS; i++) {
+        mcs_lock_node(&g_mcs_lock, &mcs_local_node);
+        mcs_data.counter++;
+        mcs_data.counter *= 2;
+        mcs_data.counter /= 2;
+        mcs_unlock_node(&g_mcs_lock, &mcs_local_node);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_mcslock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing MCS Lock... ");
+    fflush(stdout);
+
+    mcs_init(&g_mcs_lock);
+    mcs_data.counter = 0;
+    mcs_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, mcslock_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(mcs_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", mcs_data.counter);
+}
+
+/* ==================== Implicit-node MCS Tests ==================== */
+
+static mcs_lock_t g_mcs_outer = MCS_LOCK_INITIALIZER;
+static mcs_lock_t g_mcs_inner = MCS_LOCK_INITIALIZER;
+static test_data_t mcs_tls_data;
+
+static void* mcs_tls_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        mcs_lock(&g_mcs_outer);
+        mcs_tls_data.counter++;
+        mcs_lock(&g_mcs_inner);
+        mcs_tls_data.readers_active++;
+        /* Alternate LIFO and out-of-order release */
+        if (i & 1) {
+            mcs_unlock(&g_mcs_outer);
+            mcs_unlock(&g_mcs_inner);
+        } else {
+            mcs_unlock(&g_mcs_inner);
+            mcs_unlock(&g_mcs_outer);
+        }
+        if (mcs_tls.depth != 0) {
+            mcs_tls_data.error = 1;
+        }
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_mcslock_tls(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing MCS Lock (implicit nodes)... ");
+    fflush(stdout);
+
+    mcs_tls_data.counter = 0;
+    mcs_tls_data.readers_active = 0;
+    mcs_tls_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, mcs_tls_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(mcs_tls_data.error == 0);
+    assert(mcs_tls_data.counter == NUM_THREADS * ITERATIONS);
+    assert(mcs_tls_data.readers_active == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", mcs_tls_data.counter);
+}
+
+/* ==================== Parking MCS Tests ==================== */
+
+static mcs_park_lock_t g_mcs_park_lock = MCS_PARK_LOCK_INITIALIZER;
+static test_data_t mcs_park_data;
+
+static void* mcs_park_thread(void *arg)
+{
+    (void)arg;
+    mcs_park_node_t node;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        mcs_park_lock(&g_mcs_park_lock, &node);
+        if (atomic_xchg(&mcs_park_data.writer_active, 1) != 0) {
+            mcs_park_data.error = 1;
+        }
+        mcs_park_data.counter++;
+        /* Hold long enough now and then that the waiters park */
+        if (i % 1024 == 0) {
+            usleep(50);
+        }
+        atomic_store(&mcs_park_data.writer_active, 0);
+        mcs_park_unlock(&g_mcs_park_lock, &node);
+    }
+    return NULL;
+}
+
+static void test_mcs_park(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing MCS-park Lock... ");
+    fflush(stdout);
+
+    mcs_park_data.counter = 0;
+    mcs_park_data.writer_active = 0;
+    mcs_park_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, mcs_park_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(mcs_park_data.error == 0);
+    assert(mcs_park_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", mcs_park_data.counter);
+}
+
+/* ==================== Malthusian MCS Tests ==================== */
+
+static malth_lock_t g_malth_lock = MALTH_LOCK_INITIALIZER;
+static test_data_t malth_data;
+
+static void* malth_thread(void *arg)
+{
+    (void)arg;
+    malth_node_t node;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        malth_lock(&g_malth_lock, &node);
+        if (atomic_xchg(&malth_data.writer_active, 1) != 0) {
+            malth_data.error = 1;
+        }
+        malth_data.counter++;
+        /* Let a queue build up so that waiters get culled */
+        if (i % 1024 == 0) {
+            usleep(50);
+        }
+        atomic_store(&malth_data.writer_active, 0);
+        malth_unlock(&g_malth_lock, &node);
+    }
+    return NULL;
+}
+
+static void test_malthlock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Malthusian MCS Lock... ");
+    fflush(stdout);
+
+    malth_data.counter = 0;
+    malth_data.writer_active = 0;
+    malth_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, malth_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(malth_data.error == 0);
+    assert(malth_data.counter == NUM_THREADS * ITERATIONS);
+    assert(g_malth_lock.tail == NULL && g_malth_lock.passive_head == NULL);
+    printf("PASSED (counter = %u)\n", malth_data.counter);
+}
+
+/* ==================== Hemlock Tests ==================== */
+
+static hemlock_t g_hem_outer = HEMLOCK_INITIALIZER;
+static hemlock_t g_hem_inner = HEMLOCK_INITIALIZER;
+static test_data_t hemlock_data;
+
+/* Both locks share the thread's one grant word */
+static void* hemlock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        hemlock_lock(&g_hem_outer);
+        hemlock_data.counter++;
+        if (i % 4 == 0) {
+            while (!hemlock_trylock(&g_hem_inner)) {
+                cpu_pause();
+            }
+        } else {
+            hemlock_lock(&g_hem_inner);
+        }
+        hemlock_data.readers_active++;
+        if (i & 1) {
+            hemlock_unlock(&g_hem_outer);
+            hemlock_unlock(&g_hem_inner);
+        } else {
+            hemlock_unlock(&g_hem_inner);
+            hemlock_unlock(&g_hem_outer);
+        }
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_hemlock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Hemlock... ");
+    fflush(stdout);
+
+    hemlock_data.counter = 0;
+    hemlock_data.readers_active = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, hemlock_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(hemlock_data.counter == NUM_THREADS * ITERATIONS);
+    assert(hemlock_data.readers_active == NUM_THREADS * ITERATIONS);
+    assert(g_hem_outer.tail == NULL && g_hem_inner.tail == NULL);
+    printf("PASSED (counter = %u)\n", hemlock_data.counter);
+}
+
+/* ==================== CLH Lock Tests ==================== */
+
+static clh_lock_t g_clh_lock = CLH_LOCK_INITIALIZER;
+static clh_node_t clh_nodes[NUM_THREADS];
+static test_data_t clh_data;
+
+static void* clhlock_thread(void *arg)
+{
+    clh_node_t *node = (clh_node_t *)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        clh_lock(&g_clh_lock, &node);
+        clh_data.counter++;
+        clh_data.counter *= 2;
+        clh_data.counter /= 2;
+        clh_unlock(&g_clh_lock, &node);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_clhlock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing CLH Lock... ");
+    fflush(stdout);
+
+    clh_data.counter = 0;
+    clh_data.error = 0;
+
+    /* Nodes circulate, so the lock is used as statically initialized */
+    for (i = 0; i < NUM_THREADS; i++) {
+        clh_node_init(&clh_nodes[i]);
+        pthread_create(&threads[i], NULL, clhlock_thread, &clh_nodes[i]);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(clh_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", clh_data.counter);
+}
+
+/* ==================== Abortable Queue Lock Tests ==================== */
+
+/*
+ * Every fourth attempt uses a zero timeout, so aborts from the middle of
+ * the queue race with grants and with aborts of neighbouring waiters.
+ */
+#define TRY_TIMEOUT_NS(i) ((i) % 4 == 0 ? 0 : 1000000)
+
+static mcs_try_lock_t g_mcs_try_lock = MCS_TRY_LOCK_INITIALIZER;
+static test_data_t mcs_try_data;
+static volatile uint32_t mcs_try_acquired;
+static volatile uint32_t mcs_try_aborted;
+
+static void* mcs_try_thread(void *arg)
+{
+    mcs_try_node_t *node = NULL;
+    uint32_t acquired = 0, aborted = 0;
+    int i, j;
+
+    (void)arg;
+    for (i = 0; i < ITERATIONS; i++) {
+        if (!mcs_try_lock(&g_mcs_try_lock, &node, TRY_TIMEOUT_NS(i))) {
+            aborted++;
+            continue;
+        }
+        if (atomic_xchg(&mcs_try_data.writer_active, 1) != 0) {
+            mcs_try_data.error = 1;
+        }
+        mcs_try_data.counter++;
+        for (j = 0; j < i % 8; j++) {
+            cpu_pause();
+        }
+        atomic_store(&mcs_try_data.writer_active, 0);
+        mcs_try_unlock(&g_mcs_try_lock, node);
+        acquired++;
+    }
+    mcs_try_node_free(node);
+
+    atomic_fetch_add(&mcs_try_acquired, acquired);
+    atomic_fetch_add(&mcs_try_aborted, aborted);
+    return NULL;
+}
+
+/* Forced aborts: waiters with a short timeout behind a long holder */
+#define TRY_ABORT_ROUNDS     4
+#define TRY_ABORT_TIMEOUT_NS 100000
+
+static void* mcs_try_abort_thread(void *arg)
+{
+    mcs_try_node_t *node = NULL;
+    uint32_t aborted = 0;
+    int i;
+
+    (void)arg;
+    for (i = 0; i < TRY_ABORT_ROUNDS; i++) {
+        if (mcs_try_lock(&g_mcs_try_lock, &node, TRY_ABORT_TIMEOUT_NS)) {
+            mcs_try_data.error = 1;
+            mcs_try_unlock(&g_mcs_try_lock, node);
+        } else {
+            aborted++;
+        }
+    }
+    mcs_try_node_free(node);
+    atomic_fetch_add(&mcs_try_aborted, aborted);
+    return NULL;
+}
+
+/* Waits without a deadline behind the abandoned nodes */
+static void* mcs_try_patient_thread(void *arg)
+{
+    mcs_try_node_t *node = NULL;
+
+    (void)arg;
+    if (mcs_try_lock(&g_mcs_try_lock, &node, UINT64_MAX)) {
+        atomic_inc(&mcs_try_acquired);
+        mcs_try_unlock(&g_mcs_try_lock, node);
+    }
+    mcs_try_node_free(node);
+    return NULL;
+}
+
+static void test_mcs_try(void)
+{
+    pthread_t threads[NUM_THREADS];
+    mcs_try_node_t *node = NULL;
+    mcs_try_node_t *tail;
+    uint32_t forced;
+    int i;
+
+    printf("Testing MCS-try Lock... ");
+    fflush(stdout);
+
+    /*
+     * Hold the lock while the other threads time out, then queue one
+     * patient waiter: the release has to skip and free every abandoned
+     * node still linked in front of it.
+     */
+    mcs_try_init(&g_mcs_try_lock);
+    mcs_try_data.error = 0;
+    mcs_try_acquired = 0;
+    mcs_try_aborted = 0;
+    assert(mcs_try_lock(&g_mcs_try_lock, &node, 0) == 1);
+    for (i = 0; i < NUM_THREADS - 1; i++) {
+        pthread_create(&threads[i], NULL, mcs_try_abort_thread, NULL);
+    }
+    for (i = 0; i < NUM_THREADS - 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(mcs_try_data.error == 0);
+    assert(mcs_try_aborted == (NUM_THREADS - 1) * TRY_ABORT_ROUNDS);
+    forced = mcs_try_aborted;
+    tail = g_mcs_try_lock.tail;
+    pthread_create(&threads[0], NULL, mcs_try_patient_thread, NULL);
+    while (atomic_load_ptr((void *volatile *)&g_mcs_try_lock.tail) == tail) {
+        usleep(100);
+    }
+    mcs_try_unlock(&g_mcs_try_lock, node);
+    pthread_join(threads[0], NULL);
+    assert(mcs_try_acquired == 1);
+    assert(g_mcs_try_lock.tail == NULL);
+
+    mcs_try_init(&g_mcs_try_lock);
+    mcs_try_data.counter = 0;
+    mcs_try_data.writer_active = 0;
+    mcs_try_data.error = 0;
+    mcs_try_acquired = 0;
+    mcs_try_aborted = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, mcs_try_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(mcs_try_data.error == 0);
+    assert(mcs_try_data.counter == mcs_try_acquired);
+    assert(mcs_try_acquired + mcs_try_aborted == NUM_THREADS * ITERATIONS);
+
+    /* Abandoned nodes have all been skipped: the lock is free again */
+    assert(mcs_try_lock(&g_mcs_try_lock, &node, 0) == 1);
+    mcs_try_unlock(&g_mcs_try_lock, node);
+    mcs_try_node_free(node);
+
+    printf("PASSED (acquired = %u, aborted = %u, forced aborts = %u)\n",
+           mcs_try_acquired, mcs_try_aborted, forced);
+}
+
+static clh_try_lock_t g_clh_try_lock = CLH_TRY_LOCK_INITIALIZER;
+static test_data_t clh_try_data;
+static volatile uint32_t clh_try_acquired;
+static volatile uint32_t clh_try_aborted;
+
+static void* clh_try_thread(void *arg)
+{
+    clh_try_node_t *node = NULL;
+    uint32_t acquired = 0, aborted = 0;
+    int i, j;
+
+    (void)arg;
+    for (i = 0; i < ITERATIONS; i++) {
+        if (!clh_try_lock(&g_clh_try_lock, &node, TRY_TIMEOUT_NS(i))) {
+            aborted++;
+            continue;
+        }
+        if (atomic_xchg(&clh_try_data.writer_active, 1) != 0) {
+            clh_try_data.error = 1;
+        }
+        clh_try_data.counter++;
+        for (j = 0; j < i % 8; j++) {
+            cpu_pause();
+        }
+        atomic_store(&clh_try_data.writer_active, 0);
+        clh_try_unlock(&g_clh_try_lock, &node);
+        acquired++;
+    }
+    clh_try_node_free(node);
+
+    atomic_fetch_add(&clh_try_acquired, acquired);
+    atomic_fetch_add(&clh_try_aborted, aborted);
+    return NULL;
+}
+
+static void* clh_try_abort_thread(void *arg)
+{
+    clh_try_node_t *node = NULL;
+    uint32_t aborted = 0;
+    int i;
+
+    (void)arg;
+    for (i = 0; i < TRY_ABORT_ROUNDS; i++) {
+        if (clh_try_lock(&g_clh_try_lock, &node, TRY_ABORT_TIMEOUT_NS)) {
+            clh_try_data.error = 1;
+            clh_try_unlock(&g_clh_try_lock, &node);
+        } else {
+            aborted++;
+        }
+    }
+    clh_try_node_free(node);
+    atomic_fetch_add(&clh_try_aborted, aborted);
+    return NULL;
+}
+
+/* Waits without a deadline, following forwarding pointers */
+static void* clh_try_patient_thread(void *arg)
+{
+    clh_try_node_t *node = NULL;
+
+    (void)arg;
+    if (clh_try_lock(&g_clh_try_lock, &node, UINT64_MAX)) {
+        atomic_inc(&clh_try_acquired);
+        clh_try_unlock(&g_clh_try_lock, &node);
+    }
+    clh_try_node_free(node);
+    return NULL;
+}
+
+static void test_clh_try(void)
+{
+    pthread_t threads[NUM_THREADS];
+    clh_try_node_t *node = NULL;
+    clh_try_node_t *tail;
+    uint32_t forced;
+    int i;
+
+    printf("Testing CLH-try Lock... ");
+    fflush(stdout);
+
+    /* Same forced-abort pass as MCS-try, through CLH's unlink path */
+    clh_try_init(&g_clh_try_lock);
+    clh_try_data.error = 0;
+    clh_try_acquired = 0;
+    clh_try_aborted = 0;
+    assert(clh_try_lock(&g_clh_try_lock, &node, 0) == 1);
+    for (i = 0; i < NUM_THREADS - 1; i++) {
+        pthread_create(&threads[i], NULL, clh_try_abort_thread, NULL);
+    }
+    for (i = 0; i < NUM_THREADS - 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(clh_try_data.error == 0);
+    assert(clh_try_aborted == (NUM_THREADS - 1) * TRY_ABORT_ROUNDS);
+    forced = clh_try_aborted;
+    tail = g_clh_try_lock.tail;
+    pthread_create(&threads[0], NULL, clh_try_patient_thread, NULL);
+    while (atomic_load_ptr((void *volatile *)&g_clh_try_lock.tail) == tail) {
+        usleep(100);
+    }
+    clh_try_unlock(&g_clh_try_lock, &node);
+    pthread_join(threads[0], NULL);
+    assert(clh_try_acquired == 1);
+    assert(g_clh_try_lock.tail == NULL);
+
+    clh_try_init(&g_clh_try_lock);
+    clh_try_data.counter = 0;
+    clh_try_data.writer_active = 0;
+    clh_try_data.error = 0;
+    clh_try_acquired = 0;
+    clh_try_aborted = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, clh_try_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(clh_try_data.error == 0);
+    assert(clh_try_data.counter == clh_try_acquired);
+    assert(clh_try_acquired + clh_try_aborted == NUM_THREADS * ITERATIONS);
+
+    /* Timed-out nodes have all been unlinked: the lock is free again */
+    assert(clh_try_lock(&g_clh_try_lock, &node, 0) == 1);
+    clh_try_unlock(&g_clh_try_lock, &node);
+    clh_try_node_free(node);
+
+    printf("PASSED (acquired = %u, aborted = %u, forced aborts = %u)\n",
+           clh_try_acquired, clh_try_aborted, forced);
+}
+
+/* ==================== CNA Lock Tests ==================== */
+
+static cna_lock_t g_cna_lock = CNA_LOCK_INITIALIZER;
+static test_data_t cna_data;
+
+static void* cnalock_thread(void *arg)
+{
+    cna_node_t node;
+    int i;
+
+    /* Two fake NUMA nodes so handoffs build and flush secondary queues */
+    cna_set_numa_node((uint32_t)(uintptr_t)arg % 2);
+    for (i = 0; i < ITERATIONS; i++) {
+        cna_lock(&g_cna_lock, &node);
+        cna_data.counter++;
+        cna_data.counter *= 2;
+        cna_data.counter /= 2;
+        cna_unlock(&g_cna_lock, &node);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+/* Flush check: waiter i records its turn; waiter 0 is the remote one */
+#define CNA_FLUSH_WAITERS (CNA_INTRA_NODE_THRESHOLD + 2)
+
+static volatile uint32_t cna_turn;
+static uint32_t cna_turn_of[CNA_FLUSH_WAITERS];
+static volatile uintptr_t cna_remote_spin;
+
+static void* cna_flush_waiter(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    cna_node_t node;
+
+    cna_set_numa_node(id == 0 ? 1 : 0);
+    cna_lock(&g_cna_lock, &node);
+    cna_turn_of[id] = atomic_fetch_add(&cna_turn, 1);
+    if (id == 0) {
+        cna_remote_spin = node.spin;
+    }
+    cna_unlock(&g_cna_lock, &node);
+    return NULL;
+}
+
+static void test_cnalock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    cna_node_t node;
+    cna_node_t *tail;
+    int i;
+
+    printf("Testing CNA Lock... ");
+    fflush(stdout);
+
+    /*
+     * Hold the lock on node 0 and queue one node-1 waiter ahead of local
+     * ones.  Local waiters pass it for CNA_INTRA_NODE_THRESHOLD handoffs,
+     * then the forced flush hands it the lock with the secondary queue
+     * drained, before the last local waiter.
+     */
+    cna_init(&g_cna_lock);
+    cna_turn = 0;
+    cna_set_numa_node(0);
+    cna_lock(&g_cna_lock, &node);
+    for (i = 0; i < CNA_FLUSH_WAITERS; i++) {
+        tail = g_cna_lock.tail;
+        pthread_create(&threads[i], NULL, cna_flush_waiter, (void *)(uintptr_t)i);
+        while (atomic_load_ptr((void *volatile *)&g_cna_lock.tail) == tail) {
+            usleep(100);
+        }
+    }
+    cna_unlock(&g_cna_lock, &node);
+    for (i = 0; i < CNA_FLUSH_WAITERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (i = 1; i <= CNA_INTRA_NODE_THRESHOLD; i++) {
+        assert(cna_turn_of[i] == (uint32_t)i - 1);
+    }
+    assert(cna_turn_of[0] == CNA_INTRA_NODE_THRESHOLD);
+    assert(cna_remote_spin == CNA_GRANTED);
+    assert(cna_turn_of[CNA_FLUSH_WAITERS - 1] == CNA_FLUSH_WAITERS - 1);
+    assert(g_cna_lock.tail == NULL);
+
+    cna_init(&g_cna_lock);
+    cna_data.counter = 0;
+    cna_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, cnalock_thread, (void *)(uintptr_t)i);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(g_cna_lock.tail == NULL);
+    assert(cna_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", cna_data.counter);
+}
+
+/* ==================== HMCS Lock Tests ==================== */
+
+static hmcs_lock_t g_hmcs_lock;
+static test_data_t hmcs_data;
+
+static void* hmcslock_thread(void *arg)
+{
+    hmcs_node_t node;
+    int i;
+
+    hmcs_set_cpu((uint32_t)(uintptr_t)arg);
+    for (i = 0; i < ITERATIONS; i++) {
+        hmcs_lock(&g_hmcs_lock, &node);
+        hmcs_data.counter++;
+        hmcs_data.counter *= 2;
+        hmcs_data.counter /= 2;
+        hmcs_unlock(&g_hmcs_lock, &node);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void run_hmcs_threads(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    hmcs_data.counter = 0;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, hmcslock_thread, (void *)(uintptr_t)i);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(hmcs_data.counter == NUM_THREADS * ITERATIONS);
+}
+
+static void test_hmcslock(void)
+{
+    hmcs_level_t levels[3];
+    hmcs_level_t *leaf_of_cpu[2];
+    hmcs_lock_t detected;
+
+    printf("Testing HMCS Lock... ");
+    fflush(stdout);
+
+    /* Tree detected from this machine */
+    assert(hmcs_init(&g_hmcs_lock, 0) == 0);
+    assert(g_hmcs_lock.depth >= 1);
+    run_hmcs_threads();
+    detected = g_hmcs_lock;
+
+    /*
+     * Two leaves under a root regardless of the host, with a threshold of
+     * 2 so cohorts hand the root back and forth constantly
+     */
+    hmcs_level_init(&levels[2], NULL, 2);
+    hmcs_level_init(&levels[0], &levels[2], 2);
+    hmcs_level_init(&levels[1], &levels[2], 2);
+    leaf_of_cpu[0] = &levels[0];
+    leaf_of_cpu[1] = &levels[1];
+    g_hmcs_lock.levels = levels;
+    g_hmcs_lock.leaf_of_cpu = leaf_of_cpu;
+    g_hmcs_lock.num_levels = 3;
+    g_hmcs_lock.num_cpus = 2;
+    g_hmcs_lock.depth = 2;
+    run_hmcs_threads();
+    assert(levels[0].tail == NULL && levels[1].tail == NULL);
+    assert(levels[2].tail == NULL);
+
+    hmcs_destroy(&detected);
+    printf("PASSED (depth = %u, counter = %u)\n", detected.depth, hmcs_data.counter);
+}
+
+/* ==================== Shuffle Lock Tests ==================== */
+
+static shfl_lock_t g_shfl_lock = SHFL_LOCK_INITIALIZER;
+static test_data_t shfl_data;
+
+static void* shfllock_thread(void *arg)
+{
+    int i;
+
+    /* Two keys, so the head always has waiters to move and to skip */
+    shfl_set_thread_key((uint32_t)(uintptr_t)arg % 2);
+    for (i = 0; i < ITERATIONS; i++) {
+        shfl_lock(&g_shfl_lock);
+        shfl_data.counter++;
+        shfl_data.counter *= 2;
+        shfl_data.counter /= 2;
+        shfl_unlock(&g_shfl_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_shfllock(void)
+{
+    shfl_policy_fn policies[] = { shfl_policy_same_key, shfl_policy_priority };
+    pthread_t threads[NUM_THREADS];
+    int i, p;
+
+    printf("Testing Shuffle Lock... ");
+    fflush(stdout);
+
+    for (p = 0; p < 2; p++) {
+        shfl_init(&g_shfl_lock, policies[p]);
+        assert(shfl_trylock(&g_shfl_lock) == 1);
+        assert(shfl_trylock(&g_shfl_lock) == 0);
+        shfl_unlock(&g_shfl_lock);
+
+        shfl_data.counter = 0;
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_create(&threads[i], NULL, shfllock_thread, (void *)(uintptr_t)i);
+        }
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        /* Queue drained and stealing re-enabled */
+        assert(g_shfl_lock.tail == NULL && g_shfl_lock.val == 0);
+        assert(shfl_data.counter == NUM_THREADS * ITERATIONS);
+    }
+    printf("PASSED (counter = %u)\n", shfl_data.counter);
+}
+
+/* ==================== Reciprocating Lock Tests ==================== */
+
+static recip_lock_t g_recip_lock = RECIP_LOCK_INITIALIZER;
+static test_data_t recip_data;
+
+static void* reciplock_thread(void *arg)
+{
+    (void)arg;
+    recip_ctx_t ctx;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        if (i % 8 == 0) {
+            while (!recip_trylock(&g_recip_lock, &ctx)) {
+                cpu_pause();
+            }
+        } else {
+            ctx = recip_lock(&g_recip_lock);
+        }
+        if (atomic_xchg(&recip_data.writer_active, 1) != 0) {
+            recip_data.error = 1;
+        }
+        recip_data.counter++;
+        atomic_store(&recip_data.writer_active, 0);
+        recip_unlock(&g_recip_lock, ctx);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_reciplock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Reciprocating Lock... ");
+    fflush(stdout);
+
+    recip_data.counter = 0;
+    recip_data.writer_active = 0;
+    recip_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, reciplock_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(recip_data.error == 0);
+    assert(recip_data.counter == NUM_THREADS * ITERATIONS);
+    assert(g_recip_lock.arrivals == NULL);
+    printf("PASSED (counter = %u)\n", recip_data.counter);
+}
+
+/* ==================== GCR Wrapper Tests ==================== */
+
+#define GCR_TEST_MAX_ACTIVE 2
+
+static gcr_lock_t g_gcr;
+static test_data_t gcr_data;
+static volatile uint32_t gcr_max_seen;
+
+static void* gcr_thread(void *arg)
+{
+    (void)arg;
+    uint32_t active;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        gcr_lock(&g_gcr);
+        if (atomic_xchg(&gcr_data.writer_active, 1) != 0) {
+            gcr_data.error = 1;
+        }
+        gcr_data.counter++;
+        active = atomic_load(&g_gcr.active);
+        if (active > gcr_max_seen) {
+            gcr_max_seen = active;
+        }
+        atomic_store(&gcr_data.writer_active, 0);
+        gcr_unlock(&g_gcr);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_gcr(void)
+{
+    static spinlock_t spin;
+    static tatas_lock_t tatas;
+    static ticketlock_t ticket;
+    static mcs_lock_t mcs;
+    pthread_t threads[NUM_THREADS];
+    int i, k;
+
+    printf("Testing GCR wrapper... ");
+    fflush(stdout);
+
+    /* Same wrapper over each kind of inner lock */
+    for (k = 0; k < 4; k++) {
+        switch (k) {
+        case 0: spin_init(&spin); gcr_init_spin(&g_gcr, &spin, GCR_TEST_MAX_ACTIVE); break;
+        case 1: tatas_init(&tatas); gcr_init_tatas(&g_gcr, &tatas, GCR_TEST_MAX_ACTIVE); break;
+        case 2: ticket_init(&ticket); gcr_init_ticket(&g_gcr, &ticket, GCR_TEST_MAX_ACTIVE); break;
+        default: mcs_init(&mcs); gcr_init_mcs(&g_gcr, &mcs, GCR_TEST_MAX_ACTIVE); break;
+        }
+        gcr_data.counter = 0;
+        gcr_data.writer_active = 0;
+        gcr_data.error = 0;
+        gcr_max_seen = 0;
+
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_create(&threads[i], NULL, gcr_thread, NULL);
+        }
+
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        assert(gcr_data.error == 0);
+        assert(gcr_data.counter == NUM_THREADS * ITERATIONS);
+        /* An approved queue head may exceed the limit by one */
+        assert(gcr_max_seen <= GCR_TEST_MAX_ACTIVE + 1);
+        assert(g_gcr.active == 0);
+
+        /* A fairness period with nobody queued leaves no approval behind */
+        for (i = 0; i < GCR_FAIRNESS_PERIOD; i++) {
+            gcr_lock(&g_gcr);
+            gcr_unlock(&g_gcr);
+        }
+        assert(g_gcr.top_approved == 0);
+    }
+    printf("PASSED (counter = %u per inner lock)\n", gcr_data.counter);
+}
+
+/* ==================== Scheduler-Cooperative Lock Tests ==================== */
+
+static scl_lock_t g_scl_lock = SCL_LOCK_INITIALIZER;
+static scl_class_t scl_classes[NUM_THREADS / 2 + 1];
+static test_data_t scl_data;
+
+/* Even threads share class 0; odd threads have a class each */
+static void* scl_thread(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    scl_class_t *cls = &scl_classes[id % 2 == 0 ? 0 : id / 2 + 1];
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        scl_lock(&g_scl_lock, cls);
+        if (atomic_xchg(&scl_data.writer_active, 1) != 0) {
+            scl_data.error = 1;
+        }
+        scl_data.counter++;
+        atomic_store(&scl_data.writer_active, 0);
+        scl_unlock(&g_scl_lock, cls);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+#define SCL_TEST_HOLD_NS 200000
+
+static void test_scllock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int num_classes = NUM_THREADS / 2 + 1;
+    scl_lock_t lock;
+    scl_class_t a, b;
+    uint64_t start, until;
+    int i;
+
+    printf("Testing Scheduler-Cooperative Lock... ");
+    fflush(stdout);
+
+    /* With two equal classes a hold of t bans its class for another t */
+    scl_init(&lock);
+    scl_register(&lock, &a, 1);
+    scl_register(&lock, &b, 1);
+    scl_lock(&lock, &a);
+    start = cas_clock_ns();
+    while (cas_clock_ns() - start < SCL_TEST_HOLD_NS) {
+        cpu_pause();
+    }
+    scl_unlock(&lock, &a);
+    until = a.banned_until;
+    assert(a.hold_ns >= SCL_TEST_HOLD_NS);
+    assert(until >= start + 2 * SCL_TEST_HOLD_NS);
+    assert(b.banned_until == 0);
+
+    /* The banned class waits the ban out before it gets the lock again */
+    scl_lock(&lock, &a);
+    assert(cas_clock_ns() >= until);
+    scl_unlock(&lock, &a);
+    scl_unregister(&lock, &a);
+    scl_unregister(&lock, &b);
+
+    scl_data.counter = 0;
+    scl_data.writer_active = 0;
+    scl_data.error = 0;
+
+    scl_register(&g_scl_lock, &scl_classes[0], 2);
+    for (i = 1; i < num_classes; i++) {
+        scl_register(&g_scl_lock, &scl_classes[i], 1);
+    }
+    assert(g_scl_lock.total_weight == (uint32_t)num_classes + 1);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, scl_thread, (void *)(intptr_t)i);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < num_classes; i++) {
+        assert(scl_classes[i].hold_ns > 0);
+        scl_unregister(&g_scl_lock, &scl_classes[i]);
+    }
+    assert(g_scl_lock.total_weight == 0);
+    assert(scl_data.error == 0);
+    assert(scl_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", scl_data.counter);
+}
+
+/* ==================== Priority Lock Tests ==================== */
+
+static prio_lock_t g_prio_lock = PRIO_LOCK_INITIALIZER;
+static test_data_t prio_data;
+static volatile uint32_t prio_high_done;
+
+/* Odd threads take the high-priority path */
+static void* priolock_thread(void *arg)
+{
+    int high = (int)(intptr_t)arg % 2;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        prio_lock(&g_prio_lock, high);
+        if (atomic_xchg(&prio_data.writer_active, 1) != 0) {
+            prio_data.error = 1;
+        }
+        prio_data.counter++;
+        if (high) {
+            prio_high_done++;
+        }
+        atomic_store(&prio_data.writer_active, 0);
+        prio_unlock(&g_prio_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+/* Handoff order: each waiter records when it got the lock */
+static volatile uint32_t prio_order_seq;
+static volatile uint32_t prio_normal_at;
+static volatile uint32_t prio_high_at;
+static volatile uint32_t prio_stop;
+static volatile uint32_t prio_high_count;
+
+static void* prio_normal_waiter(void *arg)
+{
+    (void)arg;
+    prio_lock_normal(&g_prio_lock);
+    prio_normal_at = atomic_fetch_add(&prio_order_seq, 1);
+    atomic_store(&prio_stop, 1);
+    prio_unlock(&g_prio_lock);
+    return NULL;
+}
+
+static void* prio_high_waiter(void *arg)
+{
+    (void)arg;
+    prio_lock_high(&g_prio_lock);
+    prio_high_at = atomic_fetch_add(&prio_order_seq, 1);
+    prio_unlock(&g_prio_lock);
+    return NULL;
+}
+
+/* Keeps taking the high path until the normal waiter gets in */
+static void* prio_high_looper(void *arg)
+{
+    (void)arg;
+    while (1) {
+        prio_lock_high(&g_prio_lock);
+        if (atomic_load(&prio_stop) != 0) {
+            prio_unlock(&g_prio_lock);
+            break;
+        }
+        prio_high_count++;
+        prio_unlock(&g_prio_lock);
+    }
+    return NULL;
+}
+
+static void test_priolock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Priority Lock... ");
+    fflush(stdout);
+
+    /* A high waiter queued after a normal one still goes first */
+    prio_init(&g_prio_lock);
+    prio_order_seq = 0;
+    prio_stop = 0;
+    prio_lock_normal(&g_prio_lock);
+    pthread_create(&threads[0], NULL, prio_normal_waiter, NULL);
+    while (atomic_load(&g_prio_lock.normal_waiting) == 0) {
+        usleep(100);
+    }
+    pthread_create(&threads[1], NULL, prio_high_waiter, NULL);
+    while (atomic_load(&g_prio_lock.high_pending) == 0) {
+        usleep(100);
+    }
+    prio_unlock(&g_prio_lock);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    assert(prio_high_at == 0 && prio_normal_at == 1);
+
+    /* A waiting normal thread gets in within PRIO_MAX_HIGH_STREAK high holds */
+    prio_init(&g_prio_lock);
+    prio_stop = 0;
+    prio_high_count = 0;
+    prio_lock_normal(&g_prio_lock);
+    pthread_create(&threads[0], NULL, prio_normal_waiter, NULL);
+    while (atomic_load(&g_prio_lock.normal_waiting) == 0) {
+        usleep(100);
+    }
+    pthread_create(&threads[1], NULL, prio_high_looper, NULL);
+    pthread_create(&threads[2], NULL, prio_high_looper, NULL);
+    while (atomic_load(&g_prio_lock.high_pending) == 0) {
+        usleep(100);
+    }
+    prio_unlock(&g_prio_lock);
+    for (i = 0; i < 3; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(prio_high_count <= PRIO_MAX_HIGH_STREAK);
+
+    prio_init(&g_prio_lock);
+
+    prio_data.counter = 0;
+    prio_data.writer_active = 0;
+    prio_data.error = 0;
+    prio_high_done = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, priolock_thread, (void *)(intptr_t)i);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(prio_data.error == 0);
+    assert(prio_data.counter == NUM_THREADS * ITERATIONS);
+    assert(prio_high_done == NUM_THREADS / 2 * ITERATIONS);
+    assert(g_prio_lock.locked == 0 && g_prio_lock.high_pending == 0);
+    printf("PASSED (counter = %u, high holds before normal = %u)\n",
+           prio_data.counter, prio_high_count);
+}
+
+/* ==================== Queued Spinlock Tests ==================== */
+
+static qspinlock_t g_qspin_lock = QSPINLOCK_INITIALIZER;
+static test_data_t qspin_data;
+
+static void* qspinlock_thread(void *arg)
+{
+    (void)arg;
+    int i;
+    for (i = 0; i < ITERATIONS; i++) {
+        qspin_lock(&g_qspin_lock);
+        qspin_data.counter++;
+        qspin_data.counter *= 2;
+        qspin_data.counter /= 2;
+        qspin_unlock(&g_qspin_lock);
+        cpu_pause();
+    }
+    return NULL;
+}
+
+static void test_qspinlock(void)
+{
+    pthread_t threads[NUM_THREADS];
+    int i;
+
+    printf("Testing Queued Spinlock... ");
+    fflush(stdout);
+
+    assert(sizeof(qspinlock_t) == sizeof(spinlock_t));
+
+    qspin_init(&g_qspin_lock);
+    assert(qspin_trylock(&g_qspin_lock) == 1);
+    assert(qspin_trylock(&g_qspin_lock) == 0);
+    assert(qspin_is_locked(&g_qspin_lock));
+    assert(!qspin_is_contended(&g_qspin_lock));
+    qspin_unlock(&g_qspin_lock);
+    assert(!qspin_is_locked(&g_qspin_lock));
+
+    qspin_data.counter = 0;
+    qspin_data.error = 0;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, qspinlock_thread, NULL);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Every waiter has left the queue and handed back its node */
+    assert(g_qspin_lock.val == 0);
+    assert(qspin_data.counter == NUM_THREADS * ITERATIONS);
+    printf("PASSED (counter = %u)\n", qspin_data.counter);
+}
+
+/* ==================== Queue Estimate Tests ==================== */
+
+/* Hold the lock for a measurable time so the EWMA gets a sample */
+static void busy_hold(void)
+{
+    uint64_t start = cas_clock_ns();
+    while (cas_clock_ns() - start < 1000) {
+        cpu_pause();
+    }
+}
+
+static void test_queue_estimates(void)
+{
+    ticket_stat_lock_t ticket;
+    anderson_stat_lock_t anderson;
+    mcs_stat_lock_t mcs;
+    mcs_node_t node;
+    int i;
+
+    printf("Testing Queue Estimates... ");
+    fflush(stdout);
+
+    /* The plain locks stay at their original footprint */
+    assert(sizeof(ticketlock_t) == 8);
+    assert(sizeof(mcs_lock_t) == sizeof(void *));
+
+    ticket_stat_init(&ticket);
+    assert(anderson_stat_init(&anderson, 4) == 0);
+    mcs_stat_init(&mcs);
+    mcs_node_init(&node);
+
+    assert(ticket_queue_length(&ticket.lock) == 0);
+    assert(anderson_queue_length(&anderson) == 0);
+    assert(mcs_queue_length(&mcs) == 0);
+    assert(ticket_estimated_wait_ns(&ticket) == 0);
+
+    for (i = 0; i < 2 * LOCK_STAT_SAMPLE; i++) {
+        ticket_stat_lock(&ticket);
+        anderson_stat_lock(&anderson);
+        mcs_stat_lock(&mcs, &node);
+        assert(ticket_queue_length(&ticket.lock) == 1);
+        assert(anderson_queue_length(&anderson) == 1);
+        assert(mcs_queue_length(&mcs) == 1);
+        busy_hold();
+        mcs_stat_unlock(&mcs, &node);
+        anderson_stat_unlock(&anderson);
+        ticket_stat_unlock(&ticket);
+    }
+
+    assert(ticket_queue_length(&ticket.lock) == 0);
+    assert(anderson_queue_length(&anderson) == 0);
+    assert(mcs_queue_length(&mcs) == 0);
+
+    /* Sampled hold times are at least the busy wait */
+    assert(ticket.stat.hold_ns >= 1000);
+    assert(anderson.stat.hold_ns >= 1000);
+    assert(mcs.stat.hold_ns >= 1000);
+
+    /* A held lock with a queued ticket estimates two holds */
+    ticket_stat_lock(&ticket);
+    atomic_inc(&ticket.lock.next_ticket);
+    assert(ticket_queue_length(&ticket.lock) == 2);
+    assert(ticket_estimated_wait_ns(&ticket) == 2ULL * ticket.stat.hold_ns);
+
+    anderson_stat_destroy(&anderson);
+    printf("PASSED (hold ewma = %u ns)\n", ticket.stat.hold_ns);
 }
 
 /* ==================== Atomic Operation Tests ==================== */
@@ -346,9 +2219,33 @@ int main(int argc, char *argv[])
     /* Test all lock types */
     test_spinlock();
     test_ticketlock();
+    test_ticket_pb();
+    test_ticketlock64();
+    test_pticketlock();
+    test_twalock();
+    test_andersonlock();
+    test_ticket8_wraparound();
     test_rwlock();
-    /* MCS lock temporarily disabled - needs 64-bit atomic pointer support */
-    /* test_mcslock(); */
+    test_rwlock_ticket();
+    test_rw_br();
+    test_bravo();
+    test_mcslock();
+    test_mcslock_tls();
+    test_mcs_park();
+    test_malthlock();
+    test_hemlock();
+    test_clhlock();
+    test_mcs_try();
+    test_clh_try();
+    test_cnalock();
+    test_hmcslock();
+    test_shfllock();
+    test_reciplock();
+    test_gcr();
+    test_scllock();
+    test_priolock();
+    test_qspinlock();
+    test_queue_estimates();
 
     printf("\n===========================================\n");
     printf("All tests PASSED!\n");